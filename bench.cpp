@@ -0,0 +1,397 @@
+// Matrix Tetris headless benchmark
+// Drives the simulation core (sim.h) on a synthetic multi-monitor layout with no
+// window or GDI, and reports tick throughput plus per-phase timings and the
+// share of the screen a dirty-rect renderer would have had to redraw.
+// With --render the software renderer (softrender.h) redraws the damaged
+// rectangles every tick, and the final frame can be saved or checked against
+// a golden image. With --budget the quality governor (governor.h) scales the
+// run back whenever ticks and frames cost more than the budget; --slow stands
+// in for a slower machine, and --frame-cost replaces the measured times with
+// fixed ones so the tiers it goes through can be checked with --expect-tiers. --draw-list records the GDI renderer's draw lists
+// (drawlist.h) alongside and checks how many brush and pen changes they need.
+//
+// Usage: matrixbench [--ticks N] [--monitors N] [--width PX] [--height PX] [--seed N]
+//                    [--threads N] [--frames N] [--render] [--png FILE] [--golden FILE]
+//                    [--scanlines N] [--scanline-dim P] [--profile FILE]
+//                    [--budget MS] [--slow X] [--frame-cost MS[,MS]] [--expect-tiers LIST]
+//                    [--draw-list]
+//   --ticks N      simulation ticks to run            (default 5000)
+//   --monitors N   monitors placed side by side       (default 3)
+//   --width PX     pixel width of each monitor        (default 3840)
+//   --height PX    pixel height of each monitor       (default 2160)
+//   --seed N       random seed, for repeatable runs   (default 1)
+//   --threads N    simulation threads, 0 = one per CPU (default 0); results
+//                  are identical for any thread count
+//   --frames N     frames drawn per tick, interpolating stream positions
+//                  between ticks as a fast display would (default 1)
+//   --render       software-render every tick and time it
+//   --png FILE     write the final frame as PNG (implies --render)
+//   --golden FILE  compare the final frame against FILE, or create FILE if it
+//                  does not exist; exits 2 on mismatch (implies --render)
+//   --scanlines N  darken every Nth pixel row, 0 = none (default 3)
+//   --scanline-dim P
+//                  how much scanlines are darkened, in percent (default 100)
+//   --profile FILE write the profiler's percentiles over the last ticks and
+//                  frames (profiler.h) to FILE as CSV
+//   --budget MS    hold the time per frame (drawing it plus its share of the
+//                  ticks) under MS by lowering quality, 0 = off (default 0)
+//   --slow X       count every tick and frame as X times its measured time,
+//                  as on a slower machine (default 1)
+//   --frame-cost MS[,MS]
+//                  tell the governor every frame took MS, ticks included,
+//                  instead of timing them; a second value applies to the
+//                  second half of the run
+//   --expect-tiers LIST
+//                  comma-separated tiers the governor must go through, from 0;
+//                  exits 4 if it takes another path, or steps up sooner than
+//                  GOVERNOR_RAISE_WINDOWS windows after settling from a change
+//   --draw-list    record the block sprite sheet and every frame as draw lists;
+//                  exits 3 if the sprites need more than one state change per
+//                  color or a frame more than one per flashing monitor
+
+#include "damage.h"
+#include "drawlist.h"
+#include "governor.h"
+#include "pngfile.h"
+#include "profiler.h"
+#include "sim.h"
+#include "snapshot.h"
+#include "softrender.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+static double ElapsedMs(Clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+}
+
+static void PrintUsage() {
+    printf("Usage: matrixbench [--ticks N] [--monitors N] [--width PX] [--height PX] [--seed N]\n"
+           "                   [--threads N] [--frames N] [--render] [--png FILE] [--golden FILE]\n"
+           "                   [--scanlines N] [--scanline-dim P] [--profile FILE]\n"
+           "                   [--budget MS] [--slow X] [--frame-cost MS[,MS]] [--expect-tiers LIST]\n"
+           "                   [--draw-list]\n");
+}
+
+int main(int argc, char** argv) {
+    int ticks    = 5000;
+    int monCount = 3;
+    int monW     = 3840;
+    int monH     = 2160;
+    unsigned seed = 1;
+    int threads = 0;
+    int framesPerTick = 1;
+    bool render = false;
+    const char* pngPath = nullptr;
+    const char* goldenPath = nullptr;
+    const char* profilePath = nullptr;
+    ScanlineSettings scanlines;
+    double budgetMs = 0.0;
+    double slowdown = 1.0;
+    double frameCostMs[2] = {-1.0, -1.0};  // first and second half of the run, -1 = measure
+    std::vector<int> expectTiers;
+    bool drawListCheck = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (strcmp(arg, "--ticks") == 0 && hasValue) {
+            ticks = atoi(argv[++i]);
+        } else if (strcmp(arg, "--monitors") == 0 && hasValue) {
+            monCount = atoi(argv[++i]);
+        } else if (strcmp(arg, "--width") == 0 && hasValue) {
+            monW = atoi(argv[++i]);
+        } else if (strcmp(arg, "--height") == 0 && hasValue) {
+            monH = atoi(argv[++i]);
+        } else if (strcmp(arg, "--seed") == 0 && hasValue) {
+            seed = (unsigned)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(arg, "--threads") == 0 && hasValue) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(arg, "--frames") == 0 && hasValue) {
+            framesPerTick = atoi(argv[++i]);
+        } else if (strcmp(arg, "--scanlines") == 0 && hasValue) {
+            scanlines.pitch = atoi(argv[++i]);
+        } else if (strcmp(arg, "--scanline-dim") == 0 && hasValue) {
+            scanlines.intensity = atoi(argv[++i]) * 255 / 100;
+        } else if (strcmp(arg, "--profile") == 0 && hasValue) {
+            profilePath = argv[++i];
+        } else if (strcmp(arg, "--budget") == 0 && hasValue) {
+            budgetMs = atof(argv[++i]);
+        } else if (strcmp(arg, "--slow") == 0 && hasValue) {
+            slowdown = atof(argv[++i]);
+        } else if (strcmp(arg, "--frame-cost") == 0 && hasValue) {
+            char* end = nullptr;
+            frameCostMs[0] = frameCostMs[1] = strtod(argv[++i], &end);
+            if (*end == ',') frameCostMs[1] = strtod(end + 1, nullptr);
+        } else if (strcmp(arg, "--expect-tiers") == 0 && hasValue) {
+            char* p = argv[++i];
+            do expectTiers.push_back((int)strtol(p, &p, 10)); while (*p++ == ',');
+        } else if (strcmp(arg, "--draw-list") == 0) {
+            drawListCheck = true;
+        } else if (strcmp(arg, "--render") == 0) {
+            render = true;
+        } else if (strcmp(arg, "--png") == 0 && hasValue) {
+            pngPath = argv[++i];
+            render = true;
+        } else if (strcmp(arg, "--golden") == 0 && hasValue) {
+            goldenPath = argv[++i];
+            render = true;
+        } else {
+            PrintUsage();
+            return (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) ? 0 : 1;
+        }
+    }
+    if (ticks <= 0 || monCount <= 0 || monW < CELL || monH < CELL || threads < 0 || framesPerTick < 1 ||
+        scanlines.pitch < 0 || scanlines.intensity < 0 || scanlines.intensity > 255 || budgetMs < 0.0 ||
+        slowdown <= 0.0 || (frameCostMs[0] != -1.0 && (frameCostMs[0] < 0.0 || frameCostMs[1] < 0.0))) {
+        PrintUsage();
+        return 1;
+    }
+
+    // Monitors side by side, the same way EnumDisplayMonitors reports a wall
+    int monCols = monW / CELL;
+    int monRows = monH / CELL;
+    std::vector<MonitorGrid> monitors;
+    for (int i = 0; i < monCount; i++) {
+        monitors.push_back({i * monCols, 0, (i + 1) * monCols, monRows});
+    }
+
+    SetSimulationThreads(threads);
+    g_profiler.enabled = profilePath != nullptr;
+    Clock::time_point initStart = Clock::now();
+    InitSimulation(monCount * monCols, monRows, monitors, seed);
+    double initMs = ElapsedMs(initStart);
+
+    // Ticks reach the renderer through the same snapshot buffer the
+    // screensaver's render thread uses, on one thread here
+    SnapshotBuffer snapshots;
+    DamageTracker damage;
+    damage.Reset(monCount * monCols * CELL, monRows * CELL);
+    std::vector<PixelRect> damageRects;
+
+    SoftwareRenderer renderer;
+    renderer.scanlines = scanlines;
+    if (render) {
+        renderer.fb.Allocate(monCount * monCols * CELL, monRows * CELL);
+        renderer.atlas.BuildProcedural();
+    }
+
+    double clearsMs = 0.0, streamsMs = 0.0, fadeMs = 0.0, snapshotMs = 0.0, damageMs = 0.0, renderMs = 0.0;
+    double damagedSum = 0.0;
+    int clearsStarted = 0;
+    long long framesDrawn = 0;
+
+    // Draw lists are recorded against stand-in surfaces: only the commands
+    // and their grouping are checked, nothing is drawn
+    DrawList drawList;
+    static char landedSurface, blackSurface, blockSurface, tailSurface;
+    FrameSources drawSources = {&landedSurface, &blackSurface, &blockSurface,
+                                [](int si, void*& src, int& srcX) { src = &tailSurface; srcX = si; }};
+    int spriteCommands = 0, spriteChanges = 0;
+    long long frameCommands = 0, frameChanges = 0, badFrames = 0;
+    if (drawListCheck) {
+        RecordBlockSprites(drawList);
+        std::set<Color> fillColors, strokeColors;
+        for (const DrawFill& f : drawList.Fills()) fillColors.insert(f.color);
+        for (const DrawStroke& s : drawList.Strokes()) strokeColors.insert(s.color);
+        spriteCommands = drawList.Commands();
+        spriteChanges = drawList.StateChanges();
+        if (spriteChanges != (int)(fillColors.size() + strokeColors.size())) badFrames++;
+    }
+
+    QualityGovernor governor;
+    governor.Reset((int64_t)(budgetMs * 1e6));
+    std::vector<long long> tierFrames(NUM_QUALITY_TIERS, 0);
+    bool fixedCost = frameCostMs[0] >= 0.0;
+    std::vector<int> tierPath = {0};
+    long long lastChangeFrame = 0;
+    bool raisedEarly = false;
+
+    Clock::time_point runStart = Clock::now();
+    for (int t = 0; t < ticks; t++) {
+        int idleBefore = 0;
+        for (const auto& mci : g_monitorClears) idleBefore += (mci.phase == CLEAR_IDLE);
+
+        Clock::time_point p0 = Clock::now();
+        BeginTick();
+        UpdateClears();
+        Clock::time_point p1 = Clock::now();
+        UpdateStreams();
+        Clock::time_point p2 = Clock::now();
+        FadeLanded();
+        Clock::time_point p3 = Clock::now();
+        snapshots.Publish(t);
+        g_profiler.EndTick();
+        Clock::time_point p4 = Clock::now();
+
+        clearsMs   += std::chrono::duration<double, std::milli>(p1 - p0).count();
+        streamsMs  += std::chrono::duration<double, std::milli>(p2 - p1).count();
+        fadeMs     += std::chrono::duration<double, std::milli>(p3 - p2).count();
+        snapshotMs += std::chrono::duration<double, std::milli>(p4 - p3).count();
+        if (!fixedCost) governor.AddTick((int64_t)(std::chrono::duration<double, std::nano>(p4 - p0).count() * slowdown));
+
+        // Frames up to and including this tick's own position; all but the
+        // first reuse the snapshot
+        for (int f = 1; f <= framesPerTick; f++) {
+            Clock::time_point p5 = Clock::now();
+            if (snapshots.Acquire()) TrackTickDamage(damage, snapshots.Front());
+            SimSnapshot& snap = snapshots.Front();
+            snap.Interpolate((float)f / framesPerTick);
+            TrackFrameDamage(damage, snap);
+            if (damage.DamagedFraction() > DAMAGE_FULL_REDRAW) damage.MarkAll();
+            damage.BuildRects(damageRects);
+            damagedSum += damage.DamagedFraction();
+            if (drawListCheck) {
+                // Frames are blits apart from one flash fill color per monitor
+                RecordFrame(drawList, snap, damageRects, damage, drawSources);
+                int flashing = 0;
+                for (const auto& mci : snap.clears) flashing += (mci.phase == CLEAR_FLASH);
+                frameCommands += drawList.Commands();
+                frameChanges += drawList.StateChanges();
+                if (!drawList.Strokes().empty() || drawList.StateChanges() > flashing) badFrames++;
+            }
+            damage.Clear();
+            Clock::time_point p6 = Clock::now();
+            if (render) renderer.RenderFrame(snap, damageRects);
+            g_profiler.EndFrame();
+            Clock::time_point p7 = Clock::now();
+
+            damageMs += std::chrono::duration<double, std::milli>(p6 - p5).count();
+            renderMs += std::chrono::duration<double, std::milli>(p7 - p6).count();
+            framesDrawn++;
+            tierFrames[governor.Tier()]++;
+
+            // A new tier applies from the next tick and frame, which redraws
+            // everything in the new style
+            int64_t frameNs = fixedCost ? (int64_t)(frameCostMs[t < ticks / 2 ? 0 : 1] * 1e6)
+                                        : (int64_t)(std::chrono::duration<double, std::nano>(p7 - p5).count() * slowdown);
+            if (governor.AddFrame(frameNs)) {
+                // A step up waits out the settling windows, then a run of calm ones
+                if (governor.Tier() < tierPath.back() &&
+                    framesDrawn - lastChangeFrame < (long long)(GOVERNOR_SETTLE_WINDOWS + GOVERNOR_RAISE_WINDOWS) * GOVERNOR_WINDOW) {
+                    raisedEarly = true;
+                }
+                tierPath.push_back(governor.Tier());
+                lastChangeFrame = framesDrawn;
+
+                const QualitySettings& q = governor.Settings();
+                SetStreamQuality(q.tailStreamShare, q.maxTailLength);
+                renderer.scanlines = q.effects ? scanlines : ScanlineSettings{0, 0};
+                renderer.bevels = q.effects;
+                damage.MarkAll();
+            }
+        }
+
+        int idleAfter = 0;
+        for (const auto& mci : g_monitorClears) idleAfter += (mci.phase == CLEAR_IDLE);
+        if (idleAfter < idleBefore) clearsStarted += idleBefore - idleAfter;
+    }
+    double runMs = ElapsedMs(runStart);
+
+    printf("Layout:   %d x %dx%d px  (%d x %d cells, %d streams)\n",
+           monCount, monW, monH, g_gridCols, g_gridRows, g_streams.size());
+    printf("Threads:  %d\n", GetSimulationThreads());
+    printf("Init:     %.2f ms\n", initMs);
+    printf("Ticks:    %d in %.3f s  ->  %.1f ticks/sec\n",
+           ticks, runMs / 1000.0, ticks * 1000.0 / runMs);
+    printf("\n%-10s %12s %14s %8s\n", "phase", "total ms", "avg us/tick", "share");
+    struct { const char* name; double ms; } phases[] = {
+        {"clears",  clearsMs},
+        {"streams", streamsMs},
+        {"fade",    fadeMs},
+        {"snapshot", snapshotMs},
+        {"damage",  damageMs},
+        {"render",  renderMs},
+    };
+    double phaseTotal = clearsMs + streamsMs + fadeMs + snapshotMs + damageMs + renderMs;
+    for (const auto& p : phases) {
+        if (!render && strcmp(p.name, "render") == 0) continue;
+        printf("%-10s %12.2f %14.2f %7.1f%%\n", p.name, p.ms, p.ms * 1000.0 / ticks,
+               phaseTotal > 0.0 ? p.ms * 100.0 / phaseTotal : 0.0);
+    }
+    printf("\nDamaged area:   %.1f%% of screen per frame (avg)\n", damagedSum * 100.0 / framesDrawn);
+    printf("Snapshots:      %llu published, %llu dropped, %llu frames reused one\n",
+           (unsigned long long)snapshots.Published(), (unsigned long long)snapshots.Dropped(),
+           (unsigned long long)snapshots.Reused());
+    printf("Clears started: %d\n", clearsStarted);
+    for (int i = 0; i < (int)g_monitors.size(); i++) {
+        printf("Monitor %d fill: %.1f%%\n", i, GetMonitorFillPct(i) * 100.0f);
+    }
+    if (budgetMs > 0.0) {
+        printf("Quality:        %d tier changes, tier %d at the end, %.2f ms per frame for a %.2f ms budget\n",
+               governor.Changes(), governor.Tier(), governor.Cost() / 1e6, budgetMs);
+        printf("Frames by tier:");
+        for (int t = 0; t < NUM_QUALITY_TIERS; t++) printf(" %d: %.1f%%", t, tierFrames[t] * 100.0 / framesDrawn);
+        printf("\n");
+    }
+    if (budgetMs > 0.0 || !expectTiers.empty()) {
+        printf("Tier path:     ");
+        for (int t : tierPath) printf(" %d", t);
+        printf("\n");
+    }
+
+    if (drawListCheck) {
+        printf("Draw lists:     sprites %d commands, %d state changes; frames %.1f commands, %.2f state changes (avg)\n",
+               spriteCommands, spriteChanges, (double)frameCommands / framesDrawn, (double)frameChanges / framesDrawn);
+    }
+
+    if (profilePath) {
+        FILE* f = fopen(profilePath, "w");
+        if (!f) {
+            printf("Could not write %s\n", profilePath);
+            return 1;
+        }
+        Profiler::WriteCsvHeader(f);
+        g_profiler.WriteCsvRows(f, runMs / 1000.0);
+        fclose(f);
+        printf("Profile written to %s\n", profilePath);
+    }
+    if (pngPath) {
+        if (!WritePng(pngPath, renderer.fb)) {
+            printf("Could not write %s\n", pngPath);
+            return 1;
+        }
+        printf("Frame written to %s\n", pngPath);
+    }
+    if (goldenPath) {
+        std::vector<Pixel> golden;
+        int gw = 0, gh = 0;
+        if (!ReadPng(goldenPath, golden, gw, gh)) {
+            if (!WritePng(goldenPath, renderer.fb)) {
+                printf("Could not write %s\n", goldenPath);
+                return 1;
+            }
+            printf("Golden image %s created\n", goldenPath);
+        } else if (gw != renderer.fb.width || gh != renderer.fb.height) {
+            printf("Golden image mismatch: %dx%d expected, %dx%d rendered\n",
+                   gw, gh, renderer.fb.width, renderer.fb.height);
+            return 2;
+        } else {
+            long long diff = 0;
+            for (int y = 0; y < gh; y++) {
+                const Pixel* row = renderer.fb.Row(y);
+                for (int x = 0; x < gw; x++) diff += ((row[x] | 0xFF000000u) != golden[(size_t)y * gw + x]);
+            }
+            if (diff) {
+                printf("Golden image mismatch: %lld of %lld pixels differ\n", diff, (long long)gw * gh);
+                return 2;
+            }
+            printf("Golden image %s matches\n", goldenPath);
+        }
+    }
+    if (badFrames) {
+        printf("Draw lists: %lld need more state changes than expected\n", badFrames);
+        return 3;
+    }
+    if (!expectTiers.empty() && (tierPath != expectTiers || raisedEarly)) {
+        printf("Governor: %s\n", raisedEarly ? "stepped up before its calm windows were over" : "unexpected tier path");
+        return 4;
+    }
+    return 0;
+}
@@ -0,0 +1,247 @@
+// Matrix Tetris damage tracking — see damage.h
+
+#include "damage.h"
+
+#include <algorithm>
+
+#include "profiler.h"
+
+// ─── Pixel geometry ──────────────────────────────────────────────────────────
+
+PixelRect IntersectPixelRect(const PixelRect& a, const PixelRect& b) {
+    PixelRect r = {std::max(a.left, b.left), std::max(a.top, b.top),
+                   std::min(a.right, b.right), std::min(a.bottom, b.bottom)};
+    return r;
+}
+
+PixelRect MonitorPixelRect(const MonitorGrid& m) {
+    return {m.left * CELL, m.top * CELL, m.right * CELL, m.bottom * CELL};
+}
+
+PixelRect StreamTailRect(const StreamSet& st, int si) {
+    int headPx = st.drawPx[si];
+    int length = st.length[si];
+    // Tail connects to the topmost filled row of the piece
+    int tailStartPx = st.hasPiece[si] ? (headPx + (PIECE_SHAPES[st.pieceType[si]][st.rotation[si]].topRow - 1) * CELL) : headPx;
+    int x = st.drawCol[si] * CELL;
+    int top = tailStartPx - (length - 1) * CELL;
+    return {x, top, x + CELL, top + length * CELL};
+}
+
+PixelRect StreamPieceRect(const StreamSet& st, int si) {
+    if (!st.hasPiece[si]) return {0, 0, 0, 0};
+    const PieceShape& sh = PIECE_SHAPES[st.pieceType[si]][st.rotation[si]];
+    int headPx = st.drawPx[si];
+    int boxLeft = st.drawCol[si] - 1;
+    PixelRect rc = {(boxLeft + sh.leftCol) * CELL, headPx + sh.topRow * CELL,
+                    (boxLeft + sh.rightCol + 1) * CELL, headPx + (sh.bottomRow + 1) * CELL};
+    return IntersectPixelRect(rc, MonitorPixelRect(g_monitors[st.monitorIdx[si]]));
+}
+
+// ─── Damage map ──────────────────────────────────────────────────────────────
+
+void DamageTracker::Reset(int screenW, int screenH) {
+    widthPx  = screenW;
+    heightPx = screenH;
+    tilesX = (screenW + DAMAGE_TILE - 1) / DAMAGE_TILE;
+    tilesY = (screenH + DAMAGE_TILE - 1) / DAMAGE_TILE;
+    tiles.assign((size_t)tilesX * tilesY, 0);
+    damagedTiles = 0;
+    full = true;
+    prevTail.clear();
+    prevPiece.clear();
+    prevPieceKey.clear();
+    prevTopRow.clear();
+    prevPhase.clear();
+}
+
+void DamageTracker::Clear() {
+    if (damagedTiles) std::fill(tiles.begin(), tiles.end(), 0);
+    damagedTiles = 0;
+    full = false;
+}
+
+void DamageTracker::Add(const PixelRect& rc) {
+    if (full) return;
+    PixelRect clip = IntersectPixelRect(rc, {0, 0, widthPx, heightPx});
+    if (clip.Empty()) return;
+    int tx0 = clip.left / DAMAGE_TILE, tx1 = (clip.right - 1) / DAMAGE_TILE;
+    int ty0 = clip.top / DAMAGE_TILE,  ty1 = (clip.bottom - 1) / DAMAGE_TILE;
+    for (int ty = ty0; ty <= ty1; ty++) {
+        uint8_t* row = &tiles[(size_t)ty * tilesX];
+        for (int tx = tx0; tx <= tx1; tx++) {
+            if (!row[tx]) { row[tx] = 1; damagedTiles++; }
+        }
+    }
+}
+
+bool DamageTracker::Intersects(const PixelRect& rc) const {
+    if (full) return !rc.Empty();
+    PixelRect clip = IntersectPixelRect(rc, {0, 0, widthPx, heightPx});
+    if (clip.Empty() || !damagedTiles) return false;
+    int tx0 = clip.left / DAMAGE_TILE, tx1 = (clip.right - 1) / DAMAGE_TILE;
+    int ty0 = clip.top / DAMAGE_TILE,  ty1 = (clip.bottom - 1) / DAMAGE_TILE;
+    for (int ty = ty0; ty <= ty1; ty++) {
+        const uint8_t* row = &tiles[(size_t)ty * tilesX];
+        for (int tx = tx0; tx <= tx1; tx++) {
+            if (row[tx]) return true;
+        }
+    }
+    return false;
+}
+
+float DamageTracker::DamagedFraction() const {
+    if (full) return 1.0f;
+    if (tiles.empty()) return 0.0f;
+    return (float)damagedTiles / (float)tiles.size();
+}
+
+void DamageTracker::BuildRects(std::vector<PixelRect>& out) const {
+    ProfileScope prof(PROF_DAMAGE);
+    out.clear();
+    PixelRect screen = {0, 0, widthPx, heightPx};
+    if (full) {
+        out.push_back(screen);
+        return;
+    }
+    // Horizontal runs of damaged tiles, merged downward with an identical run
+    // in the row above
+    std::vector<int> open, nowOpen;
+    for (int ty = 0; ty < tilesY; ty++) {
+        const uint8_t* row = &tiles[(size_t)ty * tilesX];
+        nowOpen.clear();
+        int tx = 0;
+        while (tx < tilesX) {
+            if (!row[tx]) { tx++; continue; }
+            int start = tx;
+            while (tx < tilesX && row[tx]) tx++;
+            PixelRect rc = {start * DAMAGE_TILE, ty * DAMAGE_TILE, tx * DAMAGE_TILE, (ty + 1) * DAMAGE_TILE};
+            int merged = -1;
+            for (int idx : open) {
+                if (out[idx].left == rc.left && out[idx].right == rc.right) { merged = idx; break; }
+            }
+            if (merged >= 0) {
+                out[merged].bottom = rc.bottom;
+            } else {
+                merged = (int)out.size();
+                out.push_back(rc);
+            }
+            nowOpen.push_back(merged);
+        }
+        open.swap(nowOpen);
+    }
+    for (auto& rc : out) rc = IntersectPixelRect(rc, screen);
+}
+
+// ─── Per-tick and per-frame damage ──────────────────────────────────────────
+
+// Size the per-stream and per-monitor history for the current simulation
+static void SyncDamageHistory(DamageTracker& dmg, const SimSnapshot& snap) {
+    size_t numStreams = snap.streams.size();
+    size_t numMonitors = g_monitors.size();
+    if (dmg.prevTail.size() == numStreams && dmg.prevPhase.size() == numMonitors) return;
+    // First call (or the layout changed): nothing to diff against
+    dmg.prevTail.assign(numStreams, PixelRect{0, 0, 0, 0});
+    dmg.prevPiece.assign(numStreams, PixelRect{0, 0, 0, 0});
+    dmg.prevPieceKey.assign(numStreams, -1);
+    dmg.prevTopRow.assign(numMonitors, 0);
+    dmg.prevPhase.assign(numMonitors, CLEAR_IDLE);
+    dmg.MarkAll();
+}
+
+void TrackTickDamage(DamageTracker& dmg, const SimSnapshot& snap) {
+    ProfileScope prof(PROF_DAMAGE);
+    SyncDamageHistory(dmg, snap);
+    const StreamSet& st = snap.streams;
+    size_t numStreams = st.size();
+
+    // ── Streams whose content changed where they were last drawn ──────
+    for (size_t i = 0; i < numStreams; i++) {
+        int si = (int)i;
+        PixelRect mon = MonitorPixelRect(g_monitors[st.monitorIdx[si]]);
+        if (st.respawned[si]) {
+            // New tail and piece: the old footprint goes, and forgetting it
+            // makes the next frame damage the new one
+            dmg.Add(IntersectPixelRect(dmg.prevTail[i], mon));
+            dmg.Add(dmg.prevPiece[i]);
+            dmg.prevTail[i] = {0, 0, 0, 0};
+            dmg.prevPiece[i] = {0, 0, 0, 0};
+            dmg.prevPieceKey[i] = -1;
+        } else if (st.changedChar[si] >= 0) {
+            // One glyph swapped in place, in the strip as it was last drawn
+            // (the piece may have moved or turned since); index 0 (head) is
+            // the bottom cell of the strip
+            const PixelRect& strip = dmg.prevTail[i];
+            int y = strip.bottom - (st.changedChar[si] + 1) * CELL;
+            dmg.Add(IntersectPixelRect({strip.left, y, strip.right, y + CELL}, mon));
+        } else if (st.changedChar[si] == SEVERAL_CHARS_CHANGED) {
+            dmg.Add(IntersectPixelRect(dmg.prevTail[i], mon));
+        }
+    }
+
+    // ── Landed cells that landed or faded, rows cleared or shifted ────
+    for (const CellPos& p : snap.changedCells) {
+        const MonitorGrid& m = g_monitors[p.monIdx];
+        int x = (m.left + p.col) * CELL, y = (m.top + p.row) * CELL;
+        dmg.Add({x, y, x + CELL, y + CELL});
+    }
+    for (const RowBand& b : snap.changedBands) {
+        const MonitorGrid& m = g_monitors[b.monIdx];
+        dmg.Add({m.left * CELL, (m.top + b.topRow) * CELL, m.right * CELL, (m.top + b.bottomRow + 1) * CELL});
+    }
+
+    // ── Flash bars fade every tick ────────────────────────────────────
+    for (size_t mi = 0; mi < g_monitors.size(); mi++) {
+        const MonitorGrid& m = g_monitors[mi];
+        const MonitorClearInfo& mci = snap.clears[mi];
+        if (mci.phase == CLEAR_FLASH) {
+            dmg.Add({m.left * CELL, (m.top + mci.highestRow) * CELL, m.right * CELL, (m.top + mci.lowestRow + 1) * CELL});
+        }
+    }
+}
+
+void TrackFrameDamage(DamageTracker& dmg, const SimSnapshot& snap) {
+    ProfileScope prof(PROF_DAMAGE);
+    SyncDamageHistory(dmg, snap);
+    const StreamSet& st = snap.streams;
+    size_t numStreams = st.size();
+    size_t numMonitors = g_monitors.size();
+
+    // ── Streams: old and new footprint of anything that moved ─────────
+    for (size_t i = 0; i < numStreams; i++) {
+        int si = (int)i;
+        PixelRect mon  = MonitorPixelRect(g_monitors[st.monitorIdx[si]]);
+        PixelRect tail = StreamTailRect(st, si);
+        PixelRect piece = StreamPieceRect(st, si);
+        int pieceKey = st.hasPiece[si] ? st.pieceType[si] * 4 + st.rotation[si] : -1;
+
+        PixelRect& oldTail = dmg.prevTail[i];
+        PixelRect& oldPiece = dmg.prevPiece[i];
+        if (oldTail.top != tail.top || oldTail.bottom != tail.bottom || oldTail.left != tail.left) {
+            dmg.Add(IntersectPixelRect(oldTail, mon));
+            dmg.Add(IntersectPixelRect(tail, mon));
+        }
+        if (pieceKey != dmg.prevPieceKey[i] || oldPiece.left != piece.left || oldPiece.top != piece.top ||
+            oldPiece.right != piece.right || oldPiece.bottom != piece.bottom) {
+            dmg.Add(oldPiece);
+            dmg.Add(piece);
+        }
+        oldTail = tail;
+        oldPiece = piece;
+        dmg.prevPieceKey[i] = pieceKey;
+    }
+
+    // ── Drop animations ───────────────────────────────────────────────
+    for (size_t mi = 0; mi < numMonitors; mi++) {
+        const MonitorGrid& m = g_monitors[mi];
+        const MonitorClearInfo& mci = snap.clears[mi];
+        int topRow = snap.topRow[mi];
+        if (mci.phase == CLEAR_DROP || dmg.prevPhase[mi] == CLEAR_DROP) {
+            // Everything above the cleared band slides down, then settles
+            int top = std::min(topRow, dmg.prevTopRow[mi]);
+            dmg.Add({m.left * CELL, (m.top + top) * CELL, m.right * CELL, m.bottom * CELL});
+        }
+        dmg.prevTopRow[mi] = topRow;
+        dmg.prevPhase[mi] = mci.phase;
+    }
+}
@@ -0,0 +1,72 @@
+// Matrix Tetris damage tracking
+// Records which parts of the screen changed since the last presented frame so
+// the renderer can clear, redraw and present only those regions.
+// Damage is kept on a coarse tile grid: marking is O(tiles touched), and the
+// damaged tiles are coalesced into a short list of rectangles per frame.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "sim.h"
+#include "snapshot.h"
+
+// ─── Pixel geometry ──────────────────────────────────────────────────────────
+
+struct PixelRect {
+    int left, top, right, bottom;  // inclusive-exclusive, screen pixels
+
+    bool Empty() const { return right <= left || bottom <= top; }
+};
+
+PixelRect IntersectPixelRect(const PixelRect& a, const PixelRect& b);
+PixelRect MonitorPixelRect(const MonitorGrid& m);
+
+// Unclipped strip covered by a stream's tail (grows upward from the piece)
+PixelRect StreamTailRect(const StreamSet& st, int si);
+// Bounding box of a stream's piece cells, clipped to its monitor (empty for tail-only streams)
+PixelRect StreamPieceRect(const StreamSet& st, int si);
+
+// ─── Damage map ──────────────────────────────────────────────────────────────
+
+static const int   DAMAGE_TILE          = CELL * 2;  // tile edge in pixels
+static const float DAMAGE_FULL_REDRAW   = 0.60f;     // above this fraction a full redraw is cheaper
+
+struct DamageTracker {
+    int widthPx = 0, heightPx = 0;
+    int tilesX = 0, tilesY = 0;
+    std::vector<uint8_t> tiles;     // [ty * tilesX + tx], 1 = damaged
+    int  damagedTiles = 0;
+    bool full = true;               // everything must be redrawn
+
+    // Footprints drawn last frame, to damage both old and new positions
+    std::vector<PixelRect> prevTail;       // unclipped, so glyph rows can be found
+    std::vector<PixelRect> prevPiece;
+    std::vector<int>       prevPieceKey;   // pieceType * 4 + rotation
+    std::vector<int>       prevTopRow;     // per monitor: topmost content row (local)
+    std::vector<ClearPhase> prevPhase;     // per monitor: clear phase
+
+    // Size the tile grid for the screen and mark everything damaged
+    void Reset(int screenW, int screenH);
+    // Forget accumulated damage once a frame has been presented
+    void Clear();
+    void MarkAll() { full = true; }
+    void Add(const PixelRect& rc);
+    // True if any tile under rc is damaged (always true after MarkAll)
+    bool Intersects(const PixelRect& rc) const;
+    // Fraction of the screen area that needs redrawing
+    float DamagedFraction() const;
+    // Coalesce damaged tiles into disjoint rectangles, clipped to the screen
+    void BuildRects(std::vector<PixelRect>& out) const;
+};
+
+// Damage what the snapshot's ticks changed in place: respawned streams,
+// swapped glyphs, landed, faded and cleared cells, flash bars. Call once for
+// every snapshot taken.
+void TrackTickDamage(DamageTracker& dmg, const SimSnapshot& snap);
+
+// Compare stream and drop-animation positions (after Interpolate) with the
+// footprints drawn last frame and damage everything that moved.
+// Call once per frame.
+void TrackFrameDamage(DamageTracker& dmg, const SimSnapshot& snap);
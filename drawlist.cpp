@@ -0,0 +1,198 @@
+// Matrix Tetris draw list — see drawlist.h
+
+#include "drawlist.h"
+
+#include <algorithm>
+
+// ─── Recording ───────────────────────────────────────────────────────────────
+
+void DrawList::Fill(const PixelRect& rc, Color color) {
+    if (!rc.Empty()) fills.push_back({rc, color, phase});
+}
+
+void DrawList::Stroke(int x0, int y0, int x1, int y1, Color color) {
+    strokes.push_back({x0, y0, x1, y1, color, phase});
+}
+
+void DrawList::Blit(const PixelRect& dst, void* src, int srcX, int srcY, BlitMode mode) {
+    if (!dst.Empty()) blits.push_back({dst, src, srcX, srcY, mode, phase});
+}
+
+void DrawList::Barrier() {
+    barriers.push_back({(int)fills.size(), (int)strokes.size(), (int)blits.size()});
+}
+
+void DrawList::Clear() {
+    fills.clear();
+    strokes.clear();
+    blits.clear();
+    barriers.clear();
+    runs.clear();
+    stateChanges = 0;
+    phase = PROF_RECORD;
+}
+
+// ─── Grouping ────────────────────────────────────────────────────────────────
+
+// Sort commands [first, end) by color (keeping their order within a color) and
+// append one run per color, split where the phase changes
+template <typename Command>
+static void AddColorRuns(std::vector<Command>& cmds, int first, int end, DrawRunKind kind,
+                         std::vector<DrawRun>& runs) {
+    std::stable_sort(cmds.begin() + first, cmds.begin() + end,
+                     [](const Command& a, const Command& b) { return a.color < b.color; });
+    for (int i = first; i < end;) {
+        int j = i + 1;
+        while (j < end && cmds[j].color == cmds[i].color && cmds[j].phase == cmds[i].phase) j++;
+        runs.push_back({kind, cmds[i].color, i, j - i, cmds[i].phase});
+        i = j;
+    }
+}
+
+void DrawList::Build() {
+    runs.clear();
+    Mark start = {0, 0, 0};
+    Mark end = {(int)fills.size(), (int)strokes.size(), (int)blits.size()};
+    for (size_t b = 0; b <= barriers.size(); b++) {
+        Mark stop = b < barriers.size() ? barriers[b] : end;
+        AddColorRuns(fills, start.fills, stop.fills, RUN_FILLS, runs);
+        AddColorRuns(strokes, start.strokes, stop.strokes, RUN_STROKES, runs);
+        for (int i = start.blits; i < stop.blits;) {
+            int j = i + 1;
+            while (j < stop.blits && blits[j].phase == blits[i].phase) j++;
+            runs.push_back({RUN_BLITS, 0, i, j - i, blits[i].phase});
+            i = j;
+        }
+        start = stop;
+    }
+
+    // A brush or pen stays selected until a run needs another
+    stateChanges = 0;
+    bool haveBrush = false, havePen = false;
+    Color brush = 0, pen = 0;
+    for (const DrawRun& run : runs) {
+        if (run.kind == RUN_FILLS && (!haveBrush || run.color != brush)) {
+            stateChanges++;
+            haveBrush = true;
+            brush = run.color;
+        } else if (run.kind == RUN_STROKES && (!havePen || run.color != pen)) {
+            stateChanges++;
+            havePen = true;
+            pen = run.color;
+        }
+    }
+}
+
+// ─── Block sprites ───────────────────────────────────────────────────────────
+
+// Beveled block at (x, y): inner fill, highlight top/left edge and optionally
+// a shadow bottom/right edge. The edges meet without overlapping.
+static void RecordBevel(DrawList& list, int x, int y, Color fill, Color edge, const Color* shadow) {
+    list.Fill({x + 1, y + 1, x + CELL - 1, y + CELL - 1}, fill);
+    list.Stroke(x + 1, y + 1, x + CELL - 2, y + 1, edge);
+    list.Stroke(x + 1, y + 1, x + 1, y + CELL - 2, edge);
+    if (shadow) {
+        list.Stroke(x + CELL - 2, y + 1, x + CELL - 2, y + CELL - 2, *shadow);
+        list.Stroke(x + 1, y + CELL - 2, x + CELL - 2, y + CELL - 2, *shadow);
+    }
+}
+
+void RecordBlockSprites(DrawList& list) {
+    // Landed sprites of every palette share their edge colors, so edges of one
+    // glow level go out with one pen
+    list.Clear();
+    for (int p = 0; p < NUM_PIECE_COLORS; p++) {
+        for (int g = 0; g <= GLOW_STEPS; g++) {
+            const LandedShade& shade = LANDED_SHADES[g][p];
+            RecordBevel(list, p * CELL, g * CELL, shade.fill, shade.edge, nullptr);
+        }
+        Color shadow = DimColor(TETRIS_COLORS[p], 100);
+        RecordBevel(list, p * CELL, PIECE_SPRITE_ROW * CELL, TETRIS_COLORS[p], MakeColor(200, 255, 220), &shadow);
+    }
+    list.Build();
+}
+
+// ─── Frames ──────────────────────────────────────────────────────────────────
+
+void RecordFrame(DrawList& list, const SimSnapshot& snap, const std::vector<PixelRect>& rects,
+                 const DamageTracker& damage, const FrameSources& src) {
+    ProfileScope prof(PROF_RECORD);
+    list.Clear();
+
+    // Landed layer doubles as the background: black wherever nothing has landed
+    list.Phase(PROF_CLEAR);
+    for (const auto& d : rects) list.Blit(d, src.landed, d.left, d.top);
+
+    // During drop animation, slide the part of the layer above the cleared
+    // zone down by the monitor's drop offset
+    list.Phase(PROF_LANDED);
+    for (const auto& mci : snap.clears) {
+        if (mci.phase != CLEAR_DROP) continue;
+        const auto& m = g_monitors[mci.monIdx];
+        int shift = mci.drawDropOffset;
+        int x = m.left * CELL, right = m.right * CELL;
+        int srcTop = m.top * CELL;
+        int height = std::min((m.top + mci.highestRow) * CELL, m.bottom * CELL - shift) - srcTop;
+        if (height <= 0) continue;
+        list.Blit({x, srcTop, right, srcTop + shift}, src.black, x, srcTop);
+        list.Blit({x, srcTop + shift, right, srcTop + shift + height}, src.landed, x, srcTop);
+    }
+    list.Barrier();
+
+    // ── Flash animation for cleared rows (per-monitor) ───────────────────
+    list.Phase(PROF_FLASH);
+    for (const auto& mci : snap.clears) {
+        if (mci.phase != CLEAR_FLASH) continue;
+        int alpha = std::min(mci.flashTick * 12, 255);
+        const auto& m = g_monitors[mci.monIdx];
+        for (int row : mci.rows) {
+            list.Fill({m.left * CELL, (m.top + row) * CELL, m.right * CELL, (m.top + row + 1) * CELL},
+                      MakeColor(0, alpha, alpha / 3));
+        }
+    }
+    list.Barrier();
+
+    // ── Matrix streams and Tetris pieces ─────────────────────────────────
+    // Blits are drawn in the order recorded, so overlapping streams still
+    // stack in stream order
+    const StreamSet& st = snap.streams;
+    for (int si = 0; si < st.size(); si++) {
+        const auto& mon = g_monitors[st.monitorIdx[si]];
+
+        // Tail grows UPWARD from the head; clip it to the monitor boundaries
+        PixelRect tailFull = StreamTailRect(st, si);
+        PixelRect tail = IntersectPixelRect(tailFull, MonitorPixelRect(mon));
+        PixelRect piece = StreamPieceRect(st, si);
+
+        // Nothing of this stream lies in a damaged region
+        if (!damage.Intersects(tail) && !damage.Intersects(piece)) continue;
+
+        // One transparent blit for the entire tail, so tails can overlap
+        if (!tail.Empty()) {
+            list.Phase(PROF_TAILS);
+            void* tailSrc = nullptr;
+            int tailX = 0;
+            src.tail(si, tailSrc, tailX);
+            list.Blit(tail, tailSrc, tailX, tail.top - tailFull.top, BLIT_TRANSPARENT);
+        }
+
+        // Skip piece drawing for tail-only streams
+        if (!st.hasPiece[si]) continue;
+
+        // Tetris piece at the head position: only each block's inside, so
+        // whatever lies under its border shows
+        list.Phase(PROF_PIECES);
+        const PieceShape& shape = PIECE_SHAPES[st.pieceType[si]][st.rotation[si]];
+        int spriteX = st.pieceType[si] * CELL, spriteY = PIECE_SPRITE_ROW * CELL;
+        int headPx = st.drawPx[si];
+        for (int i = 0; i < 4; i++) {
+            int py = headPx + shape.cellRow[i] * CELL;
+            int gc = st.drawCol[si] + shape.cellCol[i] - 1;
+            if (py < mon.top * CELL || py + CELL > mon.bottom * CELL || gc < mon.left || gc >= mon.right) continue;
+            int px = gc * CELL;
+            list.Blit({px + 1, py + 1, px + CELL - 1, py + CELL - 1}, src.blocks, spriteX + 1, spriteY + 1);
+        }
+    }
+
+    list.Build();
+}
@@ -0,0 +1,128 @@
+// Matrix Tetris draw list
+// A frame's fills, edge strokes and blits, recorded instead of drawn straight
+// away so a backend can submit them grouped by drawing state: one brush per
+// fill color and one pen (one polyline call) per stroke color. Nothing in here
+// touches GDI, so what a frame issues can be inspected headlessly. Every
+// command carries the profiler phase it was recorded under, so a backend can
+// time its drawing per layer.
+// The GDI renderer records its block sprite sheet and every frame with the
+// functions at the end of this file.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "damage.h"
+#include "profiler.h"
+#include "sim.h"
+#include "snapshot.h"
+
+enum BlitMode {
+    BLIT_COPY,         // copy the source rectangle
+    BLIT_TRANSPARENT,  // copy all but the source's black pixels
+};
+
+struct DrawFill {
+    PixelRect    rc;
+    Color        color;
+    ProfilePhase phase;
+};
+
+// A one-pixel line from (x0, y0) up to but excluding (x1, y1)
+struct DrawStroke {
+    int          x0, y0, x1, y1;
+    Color        color;
+    ProfilePhase phase;
+};
+
+struct DrawBlit {
+    PixelRect    dst;
+    void*        src;   // the backend's source surface (an HDC for GDI)
+    int          srcX, srcY;
+    BlitMode     mode;
+    ProfilePhase phase;
+};
+
+// Consecutive commands submitted with one state, recorded under one phase
+enum DrawRunKind { RUN_FILLS, RUN_STROKES, RUN_BLITS };
+struct DrawRun {
+    DrawRunKind  kind;
+    Color        color;         // brush or pen color; unused for blits
+    int          first, count;  // range of Fills(), Strokes() or Blits()
+    ProfilePhase phase;
+};
+
+class DrawList {
+public:
+    void Fill(const PixelRect& rc, Color color);
+    void Stroke(int x0, int y0, int x1, int y1, Color color);
+    void Blit(const PixelRect& dst, void* src, int srcX, int srcY, BlitMode mode = BLIT_COPY);
+
+    // Phase the commands recorded from here on are timed under when drawn
+    // (PROF_RECORD after Clear)
+    void Phase(ProfilePhase p) { phase = p; }
+
+    // Everything recorded after a barrier is drawn over everything before it.
+    // Between barriers fills go first, then strokes, then blits in the order
+    // they were recorded; fills (or strokes) of different colors there must
+    // not overlap.
+    void Barrier();
+    void Clear();
+
+    // Group the commands into runs, once recording is done
+    void Build();
+
+    const std::vector<DrawRun>&    Runs() const    { return runs; }
+    const std::vector<DrawFill>&   Fills() const   { return fills; }
+    const std::vector<DrawStroke>& Strokes() const { return strokes; }
+    const std::vector<DrawBlit>&   Blits() const   { return blits; }
+
+    int Commands() const { return (int)(fills.size() + strokes.size() + blits.size()); }
+    // Brush and pen selections the runs need (after Build)
+    int StateChanges() const { return stateChanges; }
+
+private:
+    struct Mark {
+        int fills, strokes, blits;
+    };
+
+    std::vector<DrawFill>   fills;
+    std::vector<DrawStroke> strokes;
+    std::vector<DrawBlit>   blits;
+    std::vector<Mark>       barriers;  // command counts at each barrier
+    std::vector<DrawRun>    runs;
+    int                     stateChanges = 0;
+    ProfilePhase            phase = PROF_RECORD;
+};
+
+// ─── Block sprites ───────────────────────────────────────────────────────────
+// Sprite rows 0..GLOW_STEPS are landed blocks at each glow level
+// (LANDED_SHADES); the row after them holds falling-piece blocks, which are
+// full color and have a shadow edge. Column p is palette p. A block leaves its
+// outer pixel ring untouched, so that ring is black in the sprites.
+
+static const int PIECE_SPRITE_ROW = GLOW_STEPS + 1;
+static const int SPRITE_SHEET_W   = NUM_PIECE_COLORS * CELL;
+static const int SPRITE_SHEET_H   = (PIECE_SPRITE_ROW + 1) * CELL;
+
+// Record every block of the sheet onto a black surface and build the list
+void RecordBlockSprites(DrawList& list);
+
+// ─── Frames ──────────────────────────────────────────────────────────────────
+
+// The backend's surfaces a frame is drawn from
+struct FrameSources {
+    void* landed;  // landed layer, screen sized: black wherever nothing has landed
+    void* black;   // all black, screen sized
+    void* blocks;  // block sprite sheet
+    // The pre-rendered tail strip of stream si (one cell wide, head at the bottom)
+    void (*tail)(int si, void*& src, int& srcX);
+};
+
+// Record the damaged rectangles of a frame and build the list: the landed
+// layer and its drop animations, clear flashes, then the tail and piece of
+// every stream that touches damage, in stream order, each under its render
+// phase. The caller clips to rects. Recording is timed as PROF_RECORD.
+void RecordFrame(DrawList& list, const SimSnapshot& snap, const std::vector<PixelRect>& rects,
+                 const DamageTracker& damage, const FrameSources& src);
@@ -0,0 +1,64 @@
+// Matrix Tetris glyph set
+// Every character the rain can show (see RandMatrixChar in sim.cpp), densely
+// indexed so glyph caches are plain arrays. The lookup is a 256-entry table on
+// the low byte of the character plus one check against the glyph's character,
+// built and verified collision-free at compile time.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// ─── Character set ───────────────────────────────────────────────────────────
+
+static const int     GLYPH_NUM_KATAKANA   = 56;      // half-width katakana U+FF66 ..
+static const wchar_t GLYPH_KATAKANA_FIRST = 0xFF66;
+static const int     GLYPH_NUM_DIGITS     = 10;
+static const int     GLYPH_NUM_LATIN      = 26;      // uppercase only
+
+// Glyph indices: digits, latin, katakana, then one blank glyph for anything else
+static const int NUM_GLYPHS  = GLYPH_NUM_DIGITS + GLYPH_NUM_LATIN + GLYPH_NUM_KATAKANA + 1;
+static const int GLYPH_BLANK = NUM_GLYPHS - 1;
+
+constexpr wchar_t GlyphCharAt(int i) {
+    return i < GLYPH_NUM_DIGITS                    ? (wchar_t)(L'0' + i)
+         : i < GLYPH_NUM_DIGITS + GLYPH_NUM_LATIN  ? (wchar_t)(L'A' + (i - GLYPH_NUM_DIGITS))
+         : i < GLYPH_BLANK                         ? (wchar_t)(GLYPH_KATAKANA_FIRST + (i - GLYPH_NUM_DIGITS - GLYPH_NUM_LATIN))
+         : L' ';
+}
+
+constexpr std::array<wchar_t, NUM_GLYPHS> MakeGlyphChars() {
+    std::array<wchar_t, NUM_GLYPHS> chars = {};
+    for (int i = 0; i < NUM_GLYPHS; i++) chars[i] = GlyphCharAt(i);
+    return chars;
+}
+
+// [glyph] -> character
+static constexpr std::array<wchar_t, NUM_GLYPHS> GLYPH_CHARS = MakeGlyphChars();
+
+// ─── Lookup ──────────────────────────────────────────────────────────────────
+
+constexpr std::array<uint8_t, 256> MakeGlyphLookup() {
+    std::array<uint8_t, 256> lookup = {};
+    for (int b = 0; b < 256; b++) lookup[b] = (uint8_t)GLYPH_BLANK;
+    for (int i = 0; i < GLYPH_BLANK; i++) lookup[GLYPH_CHARS[i] & 0xFF] = (uint8_t)i;
+    return lookup;
+}
+
+// [low byte of character] -> glyph
+alignas(64) static constexpr std::array<uint8_t, 256> GLYPH_LOOKUP = MakeGlyphLookup();
+
+// No two glyphs share a low byte, so the table alone identifies a candidate
+constexpr bool GlyphLookupValid() {
+    for (int i = 0; i < GLYPH_BLANK; i++)
+        if (GLYPH_LOOKUP[GLYPH_CHARS[i] & 0xFF] != i) return false;
+    return true;
+}
+static_assert(GlyphLookupValid(), "glyph characters must have distinct low bytes");
+static_assert(NUM_GLYPHS <= 256, "glyph indices must fit in a byte");
+
+// Glyph index of a tail character; characters outside the set map to the blank glyph
+static inline int GlyphIndex(wchar_t ch) {
+    int i = GLYPH_LOOKUP[ch & 0xFF];
+    return GLYPH_CHARS[i] == ch ? i : GLYPH_BLANK;
+}
@@ -0,0 +1,66 @@
+// Matrix Tetris quality governor — see governor.h
+
+#include "governor.h"
+
+#include <algorithm>
+
+void QualityGovernor::Reset(int64_t budgetNs) {
+    budget = budgetNs;
+    tier.store(0, std::memory_order_relaxed);
+    tickNs.store(0, std::memory_order_relaxed);
+    windowNs = 0;
+    windowFrames = 0;
+    cost = 0;
+    changes = 0;
+    settling = 0;
+    calmWindows = 0;
+    raiseWindows = GOVERNOR_RAISE_WINDOWS;
+    sinceRaise = -1;
+}
+
+void QualityGovernor::SetTier(int t) {
+    tier.store(t, std::memory_order_relaxed);
+    changes++;
+    settling = GOVERNOR_SETTLE_WINDOWS;
+    calmWindows = 0;
+}
+
+bool QualityGovernor::AddFrame(int64_t ns) {
+    windowNs += ns;
+    if (++windowFrames < GOVERNOR_WINDOW) return false;
+    cost = (windowNs + tickNs.exchange(0, std::memory_order_relaxed)) / windowFrames;
+    windowNs = 0;
+    windowFrames = 0;
+    if (budget <= 0) return false;
+    if (settling > 0) {
+        settling--;
+        return false;
+    }
+
+    // A step up that holds for a trial period resets the wait before the next
+    if (sinceRaise >= 0 && ++sinceRaise >= GOVERNOR_RAISE_TRIAL) {
+        sinceRaise = -1;
+        raiseWindows = GOVERNOR_RAISE_WINDOWS;
+    }
+
+    // Only an unbroken run of windows with headroom, below the top tier and
+    // since the last change, counts toward a step up
+    int t = Tier();
+    if (cost > budget) {
+        calmWindows = 0;
+        if (t + 1 >= NUM_QUALITY_TIERS) return false;
+        // The tier above didn't fit after all: wait twice as long next time
+        if (sinceRaise >= 0) raiseWindows = std::min(raiseWindows * 2, GOVERNOR_MAX_RAISE_WINDOWS);
+        sinceRaise = -1;
+        SetTier(t + 1);
+        return true;
+    }
+    if (t == 0 || cost >= budget * GOVERNOR_RAISE_HEADROOM) {
+        calmWindows = 0;
+        return false;
+    }
+    if (++calmWindows < raiseWindows) return false;
+    sinceRaise = 0;
+    SetTier(t - 1);
+    return true;
+}
@@ -0,0 +1,79 @@
+// Matrix Tetris quality governor
+// Keeps the CPU time of a frame (drawing it, plus its share of the simulation
+// ticks that ran meanwhile) under a budget by stepping through quality tiers,
+// each giving up a little more than the one before. It steps down as soon as
+// a window of frames runs over budget, but back up only after several windows
+// with plenty of headroom, and waits longer each time a step up had to be
+// taken back, so it settles instead of flickering between two tiers.
+// Tiers only change what is drawn: the simulation keeps its fixed tick rate,
+// so streams fall at the same speed in every tier.
+// Nothing in here touches Win32: the screensaver and the headless benchmark
+// time their own ticks and frames and apply the tier's settings themselves.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// What a tier draws
+struct QualitySettings {
+    float tailStreamShare;  // share of each monitor's tail-only streams that run
+    int   maxTailLength;    // longest tail in cells, 0 = no cap
+    bool  effects;          // scanlines, and bevels in the software renderer (GDI sprites keep theirs)
+};
+
+static const QualitySettings QUALITY_TIERS[] = {
+    {1.0f, 0,  true},   // full quality
+    {0.5f, 0,  true},   // half the tail-only streams
+    {0.5f, 16, true},   // short tails
+    {0.5f, 16, false},  // no scanlines (and flat blocks in the software renderer)
+    {0.0f, 10, false},  // bare minimum
+};
+static const int NUM_QUALITY_TIERS = sizeof(QUALITY_TIERS) / sizeof(QUALITY_TIERS[0]);
+
+static const int   GOVERNOR_WINDOW         = 30;    // frames per measurement
+static const int   GOVERNOR_SETTLE_WINDOWS = 2;     // windows ignored after a change while it takes effect
+static const float GOVERNOR_RAISE_HEADROOM = 0.6f;  // step up only below this share of the budget...
+static const int   GOVERNOR_RAISE_WINDOWS  = 4;     // ...for this many windows in a row
+static const int   GOVERNOR_RAISE_TRIAL    = 8;     // windows a step up must last to count as good
+static const int   GOVERNOR_MAX_RAISE_WINDOWS = 64;
+
+class QualityGovernor {
+public:
+    // Budget for the CPU time of one frame; 0 keeps full quality. Call
+    // before the first sample.
+    void Reset(int64_t budgetNs);
+
+    // Simulation side (any thread): one tick took ns
+    void AddTick(int64_t ns) { tickNs.fetch_add(ns, std::memory_order_relaxed); }
+
+    // Render side: one frame took ns. At the end of every window of frames
+    // the window's cost is checked against the budget; returns true if the
+    // tier changed.
+    bool AddFrame(int64_t ns);
+
+    // Readable from any thread
+    int Tier() const { return tier.load(std::memory_order_relaxed); }
+    const QualitySettings& Settings() const { return QUALITY_TIERS[Tier()]; }
+
+    // Render side
+    int64_t Budget() const { return budget; }
+    int64_t Cost() const { return cost; }        // ns per frame over the last window
+    int     Changes() const { return changes; }  // tier changes so far
+
+private:
+    int64_t              budget = 0;
+    std::atomic<int>     tier{0};
+    std::atomic<int64_t> tickNs{0};    // tick time since the last window closed
+
+    int64_t windowNs = 0;              // frame time in the current window
+    int     windowFrames = 0;
+    int64_t cost = 0;
+    int     changes = 0;
+    int     settling = 0;              // windows left to ignore
+    int     calmWindows = 0;           // windows in a row with headroom to step up
+    int     raiseWindows = GOVERNOR_RAISE_WINDOWS;
+    int     sinceRaise = -1;           // windows since the last step up, -1 once it proved good
+
+    void SetTier(int t);
+};
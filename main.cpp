@@ -10,158 +10,42 @@
 #include <windows.h>
 #include <shellapi.h>
 #include <shellscalingapi.h>
+#include <dwmapi.h>
+#include <mmsystem.h>
 #include <cstdlib>
 #include <ctime>
 #include <cstring>
+#include <cwchar>
+#include <cstdio>
 #include <cmath>
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
 
 #include "resource.h"
+#include "sim.h"
+#include "snapshot.h"
+#include "damage.h"
+#include "drawlist.h"
+#include "governor.h"
+#include "renderer.h"
+#include "softrender.h"
+#include "profiler.h"
 
 // ─── Constants ───────────────────────────────────────────────────────────────
 
 static const wchar_t CLASS_NAME[]  = L"MatrixTetrisScrSaver";
-static const int     TIMER_ID      = 1;
-static const int     FRAME_MS      = 45;        // ~22 fps
-static const int     CELL           = 16;        // pixel size of one grid cell
-static const float   FILL_CLEAR_PCT = 0.30f;      // trigger clear when a monitor reaches 30% fill
-static const int     ROWS_TO_CLEAR  = 4;
-
-// Matrix green palette (exponential curve: bright head → dark green tail)
-static const COLORREF MATRIX_GREENS[] = {
-    RGB(218, 255, 228),   // 0 – bright white-green (very tip)
-    RGB(120, 255, 160),   // 1 – bright green-white
-    RGB(60, 255, 120),    // 2 – vivid bright green
-    RGB(20, 250, 90),     // 3 – bright green
-    RGB(0, 230, 75),      // 4 – strong green
-    RGB(0, 200, 60),      // 5
-    RGB(0, 165, 48),      // 6
-    RGB(0, 130, 36),      // 7
-    RGB(0, 95, 26),       // 8
-    RGB(0, 65, 18),       // 9
-    RGB(0, 42, 11),       // 10
-    RGB(0, 28, 7),        // 11 – very dark
-};
-static const int NUM_GREENS = sizeof(MATRIX_GREENS) / sizeof(MATRIX_GREENS[0]);
-
-// Tetris piece colors (all given a green/matrix tint)
-static const COLORREF TETRIS_COLORS[] = {
-    RGB(0, 255, 100),   // I  – bright green
-    RGB(0, 200, 80),    // O  – medium green
-    RGB(50, 255, 130),  // T  – lime
-    RGB(0, 180, 60),    // S  – forest
-    RGB(30, 230, 90),   // Z  – emerald
-    RGB(0, 160, 70),    // J  – teal-green
-    RGB(80, 255, 140),  // L  – mint
-};
-
-// ─── Tetris Piece Definitions ────────────────────────────────────────────────
-// Each piece is 4 rotations of 4×4 bitmask (stored as 4 rows of 4 bits)
-
-struct PieceDef {
-    int cells[4][4][4]; // [rotation][row][col]  1=filled
-};
-
-static const PieceDef PIECES[7] = {
-    // I
-    {{{
-        {0,0,0,0},{1,1,1,1},{0,0,0,0},{0,0,0,0}},
-        {{0,0,1,0},{0,0,1,0},{0,0,1,0},{0,0,1,0}},
-        {{0,0,0,0},{0,0,0,0},{1,1,1,1},{0,0,0,0}},
-        {{0,1,0,0},{0,1,0,0},{0,1,0,0},{0,1,0,0}}
-    }},
-    // O
-    {{{
-        {0,1,1,0},{0,1,1,0},{0,0,0,0},{0,0,0,0}},
-        {{0,1,1,0},{0,1,1,0},{0,0,0,0},{0,0,0,0}},
-        {{0,1,1,0},{0,1,1,0},{0,0,0,0},{0,0,0,0}},
-        {{0,1,1,0},{0,1,1,0},{0,0,0,0},{0,0,0,0}}
-    }},
-    // T
-    {{{
-        {0,1,0,0},{1,1,1,0},{0,0,0,0},{0,0,0,0}},
-        {{0,1,0,0},{0,1,1,0},{0,1,0,0},{0,0,0,0}},
-        {{0,0,0,0},{1,1,1,0},{0,1,0,0},{0,0,0,0}},
-        {{0,1,0,0},{1,1,0,0},{0,1,0,0},{0,0,0,0}}
-    }},
-    // S
-    {{{
-        {0,1,1,0},{1,1,0,0},{0,0,0,0},{0,0,0,0}},
-        {{0,1,0,0},{0,1,1,0},{0,0,1,0},{0,0,0,0}},
-        {{0,0,0,0},{0,1,1,0},{1,1,0,0},{0,0,0,0}},
-        {{1,0,0,0},{1,1,0,0},{0,1,0,0},{0,0,0,0}}
-    }},
-    // Z
-    {{{
-        {1,1,0,0},{0,1,1,0},{0,0,0,0},{0,0,0,0}},
-        {{0,0,1,0},{0,1,1,0},{0,1,0,0},{0,0,0,0}},
-        {{0,0,0,0},{1,1,0,0},{0,1,1,0},{0,0,0,0}},
-        {{0,1,0,0},{1,1,0,0},{1,0,0,0},{0,0,0,0}}
-    }},
-    // J
-    {{{
-        {1,0,0,0},{1,1,1,0},{0,0,0,0},{0,0,0,0}},
-        {{0,1,1,0},{0,1,0,0},{0,1,0,0},{0,0,0,0}},
-        {{0,0,0,0},{1,1,1,0},{0,0,1,0},{0,0,0,0}},
-        {{0,1,0,0},{0,1,0,0},{1,1,0,0},{0,0,0,0}}
-    }},
-    // L
-    {{{
-        {0,0,1,0},{1,1,1,0},{0,0,0,0},{0,0,0,0}},
-        {{0,1,0,0},{0,1,0,0},{0,1,1,0},{0,0,0,0}},
-        {{0,0,0,0},{1,1,1,0},{1,0,0,0},{0,0,0,0}},
-        {{1,1,0,0},{0,1,0,0},{0,1,0,0},{0,0,0,0}}
-    }}
-};
-
-// ─── Matrix rain character stream ────────────────────────────────────────────
-
-struct MatrixStream {
-    int   col;              // grid column
-    float y;                // current head position (grid row, fractional)
-    float speed;            // cells per tick
-    int   length;           // tail length in cells
-    std::vector<wchar_t> chars; // characters in the tail
-
-    // Tetris piece at the bottom of this stream
-    int   pieceType;        // 0-6
-    int   rotation;         // 0-3
-    COLORREF pieceColor;
-    int   ticksToRotate;    // ticks until next rotation change
-    bool  hardDropping;     // currently doing a fast drop
-    float origSpeed;        // speed before hard-drop
-    int   ticksToHardDrop;  // ticks until a hard-drop triggers
-    int   monitorIdx;       // which monitor this stream belongs to
-    bool  hasPiece;         // false = tail-only stream (no tetromino)
-    std::vector<COLORREF> tailColors; // pre-computed color gradient (cached)
-    std::vector<int> tailColorIndices; // color index for cache lookup
-
-    // Pre-rendered tail bitmap for fast blitting
-    HDC     tailDC;
-    HBITMAP tailBmp;
-    HBITMAP tailOldBmp;
-    bool    tailDirty;      // true if tail needs re-rendering
-};
-
-// ─── Landed Tetris grid ──────────────────────────────────────────────────────
-
-struct LandedCell {
-    bool     filled;
-    COLORREF color;
-    int      brightness; // 0-255, for glow effect on placement
-};
-
-// ─── Monitor info ────────────────────────────────────────────────────────────
-
-struct MonitorGrid {
-    int left, top, right, bottom;  // grid-coordinate bounds (inclusive-exclusive)
-};
+static const int     SIM_TICK_MS   = 45;        // default simulation step (~22 Hz); speeds are cells per tick
+static const int     MAX_CATCHUP_TICKS = 5;     // ticks behind schedule before a stall is written off
+static const int     FALLBACK_FPS  = 60;        // frame pacing when vsync is unavailable
+static const int     STATS_REPORT_SECONDS = 10; // how often frame counters go to the debugger
+static const int     STATS_REFRESH_MS = 250;    // how often the /stats overlay text changes
+static const int     PROFILE_CSV_SECONDS = 1;   // how often /profile appends to its CSV
 
 // ─── Globals ─────────────────────────────────────────────────────────────────
 
-static int          g_gridCols    = 0;
-static int          g_gridRows    = 0;
 static int          g_screenW     = 0;
 static int          g_screenH     = 0;
 static int          g_virtualX    = 0;  // virtual screen origin in screen coords
@@ -179,24 +63,38 @@ static HDC          g_blackDC = nullptr;
 static HBITMAP      g_blackBmp = nullptr;
 static HBITMAP      g_blackOldBmp = nullptr;
 
-static std::vector<MonitorGrid>             g_monitors;
-
-static std::vector<MatrixStream>            g_streams;
-static std::vector<std::vector<LandedCell>> g_landed;  // [row][col]
-
-// Per-monitor clear tracking — each monitor clears independently
-enum ClearPhase { CLEAR_IDLE, CLEAR_FLASH, CLEAR_DROP };
-struct MonitorClearInfo {
-    int monIdx;             // which monitor
-    ClearPhase phase;       // per-monitor clear phase
-    int flashTick;          // countdown for flash
-    std::vector<int> rows;  // rows being cleared (in grid coords)
-    float dropOffset;       // current pixel offset during drop anim
-    float dropTarget;       // target pixel offset
-    int   lowestRow;        // lowest (bottom-most) cleared row
-    int   highestRow;       // highest (top-most) cleared row
+// Block sprites - every beveled block pre-rendered, one column per piece color
+static HDC          g_blockDC = nullptr;
+static HBITMAP      g_blockBmp = nullptr;
+static HBITMAP      g_blockOldBmp = nullptr;
+
+// Landed blocks, drawn once when they change and composited every frame
+static HDC          g_landedDC = nullptr;
+static HBITMAP      g_landedBmp = nullptr;
+static HBITMAP      g_landedOldBmp = nullptr;
+
+// Pre-rendered tails for fast blitting. Tails live in shared slab bitmaps,
+// one slot per stream, pooled by length class (multiples of TAIL_CLASS_ROWS
+// cells). A respawning stream trades its slot for a free one of the right
+// class, so GDI objects are only created when a class runs out of slots.
+static const int TAIL_CLASS_ROWS = 8;   // cells of tail height per length class
+static const int TAIL_SLAB_SLOTS = 64;  // slots per slab bitmap (side by side)
+
+struct TailSlab {
+    HDC     dc;
+    HBITMAP bmp;
+    HBITMAP oldBmp;
+};
+struct TailClass {
+    std::vector<TailSlab> slabs;
+    std::vector<int>      freeSlots;  // slab * TAIL_SLAB_SLOTS + column
+};
+struct TailSlot {
+    int cls;   // length class, 0 = none
+    int slot;  // slab * TAIL_SLAB_SLOTS + column
 };
-static std::vector<MonitorClearInfo> g_monitorClears; // one per monitor
+static std::vector<TailClass> g_tailClasses;  // [length class]
+static std::vector<TailSlot>  g_tails;        // one per stream (parallel to g_streams)
 
 static bool  g_isPreview = false;
 static POINT g_initCursorPos;
@@ -204,35 +102,50 @@ static bool  g_active = true;
 static int   g_targetMonitor = -1; // /m N switch: -1 = all monitors, 0+ = specific monitor index
 static int   g_targetMonX = 0;    // pixel origin of targeted monitor
 static int   g_targetMonY = 0;
+static bool  g_softwareRender = false; // /sw switch: software framebuffer renderer instead of GDI
+static bool  g_fixedSeed = false;     // /seed N switch: replay a run instead of seeding from the clock
+static uint32_t g_seed = 0;
+static double g_tickMs    = SIM_TICK_MS; // /simhz N switch: simulation steps per second
+static int    g_targetFps = 0;           // /fps N switch: 0 = pace frames to the display's vsync
+static ScanlineSettings g_scanlines;     // /scanlines N and /scanlinedim P switches
+static bool   g_showStats = false;       // /stats switch: profiler overlay on the first monitor
+static double g_frameBudgetMs = 0.0;     // /budget MS switch: 0 = keep full quality
+static wchar_t g_profilePath[MAX_PATH] = {}; // /profile FILE switch: profiler percentiles as CSV
+
+// The simulation thread ticks on a fixed schedule and publishes a snapshot
+// after every tick; the render thread draws the newest one at display rate,
+// interpolated by how far into the next tick it is. The window thread only
+// pumps messages.
+static LARGE_INTEGER     g_qpcFreq;
+static SnapshotBuffer    g_snapshots;
+static std::thread       g_simThread;
+static std::thread       g_renderThread;
+static std::atomic<bool> g_stopThreads{false};
+static std::atomic<bool> g_presentAll{false};  // window was exposed: present the whole back buffer
+static QualityGovernor   g_governor;           // fed by both threads, steps quality down when they run over
 
 // Persistent double-buffer
 static HDC     g_memDC  = nullptr;
 static HBITMAP g_memBmp = nullptr;
 static HBITMAP g_oldBmp = nullptr;
 
-// Cached GDI pens for rendering
-static HPEN g_highlightPen = nullptr;  // bright edge for blocks
-static HPEN g_scanlinePen  = nullptr;  // scanline overlay
+// Screen regions that changed since the last presented frame
+static DamageTracker          g_damage;
+static std::vector<PixelRect> g_damageRects;     // this frame's redraw rectangles
+static float                  g_damagePct = 100.0f; // share of the screen redrawn last frame
 
-// ─── Helpers ─────────────────────────────────────────────────────────────────
-
-static inline int RandInt(int lo, int hi) {
-    return lo + rand() % (hi - lo + 1);
-}
-static inline float RandFloat(float lo, float hi) {
-    return lo + (float)rand() / RAND_MAX * (hi - lo);
-}
-static wchar_t RandMatrixChar() {
-    // Half-width katakana + digits + latin
-    int r = rand() % 3;
-    if (r == 0) return (wchar_t)(0xFF66 + rand() % 56);   // katakana
-    if (r == 1) return (wchar_t)('0' + rand() % 10);       // digits
-    return (wchar_t)('A' + rand() % 26);                    // latin
-}
+// Scanline mask (see CreateScanlineMask); at most one of the two is in use
+static HBRUSH  g_scanlineBrush = nullptr;   // pattern ANDed over the frame: black scanlines
+static HDC     g_scanlineDC = nullptr;      // per-row alpha column: dimmed scanlines
+static HBITMAP g_scanlineBmp = nullptr;     // the brush pattern or the alpha column
+static HBITMAP g_scanlineOldBmp = nullptr;
 
 // ─── Monitor enumeration ─────────────────────────────────────────────────────
 
-static BOOL CALLBACK MonitorEnumProc(HMONITOR, HDC, LPRECT lprc, LPARAM) {
+static BOOL CALLBACK MonitorEnumProc(HMONITOR, HDC, LPRECT lprc, LPARAM data) {
+    auto* monitors = (std::vector<MonitorGrid>*)data;
+    int gridCols = g_screenW / CELL;
+    int gridRows = g_screenH / CELL;
     MonitorGrid mg;
     mg.left   = (lprc->left   - g_virtualX) / CELL;
     mg.top    = (lprc->top    - g_virtualY) / CELL;
@@ -241,25 +154,19 @@ static BOOL CALLBACK MonitorEnumProc(HMONITOR, HDC, LPRECT lprc, LPARAM) {
     // Clamp to grid bounds
     if (mg.left < 0) mg.left = 0;
     if (mg.top  < 0) mg.top  = 0;
-    if (mg.right  > g_gridCols) mg.right  = g_gridCols;
-    if (mg.bottom > g_gridRows) mg.bottom = g_gridRows;
-    g_monitors.push_back(mg);
+    if (mg.right  > gridCols) mg.right  = gridCols;
+    if (mg.bottom > gridRows) mg.bottom = gridRows;
+    monitors->push_back(mg);
     return TRUE;
 }
 
-// Forward declarations
-static void ComputeTailColors(MatrixStream& s);
-static void CreateTailBitmap(MatrixStream& s, HDC screenDC);
-static void RenderTailBitmap(MatrixStream& s);
-static void CleanupTailBitmap(MatrixStream& s);
-
 // ─── Character Cache Creation ────────────────────────────────────────────────
 
 static void CreateCharacterCache(HDC screenDC) {
-    // Create bitmap to hold pre-rendered characters at each color
-    // We'll cache the most common Matrix characters at each of the 12 green shades
-    int cacheW = 128 * CELL;  // Wide enough for diverse character set
-    int cacheH = NUM_GREENS * CELL;
+    // Create bitmap to hold every glyph pre-rendered at every tail shade:
+    // column = glyph index (glyphs.h), row = TailShade index
+    int cacheW = NUM_GLYPHS * CELL;
+    int cacheH = NUM_TAIL_SHADES * CELL;
 
     g_charCacheDC = CreateCompatibleDC(screenDC);
     g_charCacheBmp = CreateCompatibleBitmap(screenDC, cacheW, cacheH);
@@ -273,84 +180,288 @@ static void CreateCharacterCache(HDC screenDC) {
     SetBkMode(g_charCacheDC, TRANSPARENT);
     SelectObject(g_charCacheDC, g_font);
 
-    // Pre-render characters at each color
-    wchar_t chars[] = L"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789$#@*+-=<>[]{}|\\/:;,.!?";
-    int numChars = static_cast<int>(wcslen(chars));
+    // Pre-render characters at each shade; the blank glyph stays black
+    for (int shade = 0; shade < NUM_TAIL_SHADES; shade++) {
+        SetTextColor(g_charCacheDC, TailShade(shade));
+        int y = shade * CELL;
 
-    for (int colorIdx = 0; colorIdx < NUM_GREENS; colorIdx++) {
-        SetTextColor(g_charCacheDC, MATRIX_GREENS[colorIdx]);
-        int y = colorIdx * CELL;
-
-        for (int i = 0; i < numChars && i < 128; i++) {
-            wchar_t str[2] = {chars[i], 0};
+        for (int i = 0; i < GLYPH_BLANK; i++) {
+            wchar_t str[2] = {GLYPH_CHARS[i], 0};
             int x = i * CELL;
             TextOutW(g_charCacheDC, x, y, str, 1);
         }
     }
 }
 
-static inline int GetCharCacheIndex(wchar_t ch) {
-    // Map character to cache position
-    if (ch >= L'A' && ch <= L'Z') return ch - L'A';
-    if (ch >= L'a' && ch <= L'z') return 26 + (ch - L'a');
-    if (ch >= L'0' && ch <= L'9') return 52 + (ch - L'0');
-    // Special characters
-    switch(ch) {
-        case L'$': return 62;
-        case L'#': return 63;
-        case L'@': return 64;
-        case L'*': return 65;
-        case L'+': return 66;
-        case L'-': return 67;
-        default: return 0; // Fallback to 'A'
+// ─── Draw List Submission ────────────────────────────────────────────────────
+// Brushes and pens are created the first time a color is drawn and then kept,
+// so steady frames create no GDI objects at all.
+
+class GdiObjectCache {
+public:
+    HBRUSH Brush(Color color) {
+        HBRUSH& br = brushes[color];
+        if (!br) br = CreateSolidBrush(color);
+        return br;
+    }
+    HPEN Pen(Color color) {
+        HPEN& pen = pens[color];
+        if (!pen) pen = CreatePen(PS_SOLID, 1, color);
+        return pen;
+    }
+    // None of the objects may still be selected into a DC
+    void Clear() {
+        for (auto& b : brushes) DeleteObject(b.second);
+        for (auto& p : pens) DeleteObject(p.second);
+        brushes.clear();
+        pens.clear();
+    }
+
+private:
+    std::unordered_map<Color, HBRUSH> brushes;
+    std::unordered_map<Color, HPEN>   pens;
+};
+
+static DrawList           g_drawList;     // the GDI renderer's frame
+static GdiObjectCache     g_gdiObjects;   // brushes and pens g_drawList is drawn with
+static std::vector<POINT> g_strokePoints; // PolyPolyline arguments of one pen's run
+static std::vector<DWORD> g_strokeCounts;
+
+// Draw a built list: one brush or pen selection per state change, one
+// PolyPolyline per run of strokes. Each run's drawing is timed under the
+// phase it was recorded in.
+static void SubmitDrawList(HDC hdc, const DrawList& list, GdiObjectCache& objects) {
+    ProfileScope prof(PROF_RECORD);
+    HGDIOBJ oldBrush = GetCurrentObject(hdc, OBJ_BRUSH);
+    HGDIOBJ oldPen = GetCurrentObject(hdc, OBJ_PEN);
+    for (const DrawRun& run : list.Runs()) {
+        prof.Switch(run.phase);
+        int end = run.first + run.count;
+        if (run.kind == RUN_FILLS) {
+            SelectObject(hdc, objects.Brush(run.color));
+            for (int i = run.first; i < end; i++) {
+                const PixelRect& rc = list.Fills()[i].rc;
+                PatBlt(hdc, rc.left, rc.top, rc.right - rc.left, rc.bottom - rc.top, PATCOPY);
+            }
+        } else if (run.kind == RUN_STROKES) {
+            SelectObject(hdc, objects.Pen(run.color));
+            g_strokePoints.clear();
+            for (int i = run.first; i < end; i++) {
+                const DrawStroke& s = list.Strokes()[i];
+                g_strokePoints.push_back({s.x0, s.y0});
+                g_strokePoints.push_back({s.x1, s.y1});
+            }
+            g_strokeCounts.assign(run.count, 2);
+            PolyPolyline(hdc, g_strokePoints.data(), g_strokeCounts.data(), run.count);
+        } else {
+            for (int i = run.first; i < end; i++) {
+                const DrawBlit& b = list.Blits()[i];
+                int w = b.dst.right - b.dst.left, h = b.dst.bottom - b.dst.top;
+                if (b.mode == BLIT_TRANSPARENT) {
+                    TransparentBlt(hdc, b.dst.left, b.dst.top, w, h, (HDC)b.src, b.srcX, b.srcY, w, h,
+                                   RGB(0, 0, 0));  // black is transparent
+                } else {
+                    BitBlt(hdc, b.dst.left, b.dst.top, w, h, (HDC)b.src, b.srcX, b.srcY, SRCCOPY);
+                }
+            }
+        }
+    }
+    SelectObject(hdc, oldBrush);
+    SelectObject(hdc, oldPen);
+}
+
+// ─── Block Sprites ───────────────────────────────────────────────────────────
+// Layout and drawing live in RecordBlockSprites (drawlist.h)
+
+static void CreateBlockSprites(HDC screenDC) {
+    g_blockDC = CreateCompatibleDC(screenDC);
+    g_blockBmp = CreateCompatibleBitmap(screenDC, SPRITE_SHEET_W, SPRITE_SHEET_H);
+    g_blockOldBmp = (HBITMAP)SelectObject(g_blockDC, g_blockBmp);
+    RECT rcAll = {0, 0, SPRITE_SHEET_W, SPRITE_SHEET_H};
+    FillRect(g_blockDC, &rcAll, (HBRUSH)GetStockObject(BLACK_BRUSH));
+
+    DrawList list;
+    RecordBlockSprites(list);
+    // Sprite colors are drawn once; their brushes and pens aren't kept
+    GdiObjectCache objects;
+    SubmitDrawList(g_blockDC, list, objects);
+    objects.Clear();
+}
+
+// ─── Scanlines ───────────────────────────────────────────────────────────────
+// One blit per damaged rectangle darkens every scanline in it. Black
+// scanlines AND the frame with a pattern brush, pitch rows tall: black on its
+// first row, white below. Dimmed ones alpha-blend a one-pixel-wide column of
+// premultiplied black, built from the row mask, stretched across the rect.
+
+static const DWORD ROP_DEST_AND_PATTERN = 0x00A000C9;  // DPa
+
+static void CreateScanlineMask(HDC screenDC) {
+    if (!g_scanlines.Enabled()) return;
+    if (g_scanlines.intensity >= 255) {
+        int pitch = g_scanlines.pitch;
+        HDC dc = CreateCompatibleDC(screenDC);
+        g_scanlineBmp = CreateCompatibleBitmap(screenDC, 8, pitch);
+        HBITMAP oldBmp = (HBITMAP)SelectObject(dc, g_scanlineBmp);
+        RECT rc = {0, 0, 8, pitch};
+        FillRect(dc, &rc, (HBRUSH)GetStockObject(WHITE_BRUSH));
+        rc.bottom = 1;
+        FillRect(dc, &rc, (HBRUSH)GetStockObject(BLACK_BRUSH));
+        SelectObject(dc, oldBmp);
+        DeleteDC(dc);
+        g_scanlineBrush = CreatePatternBrush(g_scanlineBmp);
+        return;
+    }
+
+    std::vector<uint8_t> mask;
+    g_scanlines.BuildMask(mask, g_screenH);
+    BITMAPINFO bi = {};
+    bi.bmiHeader.biSize        = sizeof(bi.bmiHeader);
+    bi.bmiHeader.biWidth       = 1;
+    bi.bmiHeader.biHeight      = -g_screenH;  // top-down
+    bi.bmiHeader.biPlanes      = 1;
+    bi.bmiHeader.biBitCount    = 32;
+    bi.bmiHeader.biCompression = BI_RGB;
+    void* bits = nullptr;
+    g_scanlineBmp = CreateDIBSection(screenDC, &bi, DIB_RGB_COLORS, &bits, nullptr, 0);
+    uint32_t* px = (uint32_t*)bits;
+    for (int y = 0; y < g_screenH; y++) px[y] = (uint32_t)mask[y] << 24;
+    g_scanlineDC = CreateCompatibleDC(screenDC);
+    g_scanlineOldBmp = (HBITMAP)SelectObject(g_scanlineDC, g_scanlineBmp);
+}
+
+static void ApplyScanlines(HDC hdc, const std::vector<PixelRect>& rects) {
+    if (g_scanlineBrush) {
+        HBRUSH oldBrush = (HBRUSH)SelectObject(hdc, g_scanlineBrush);
+        SetBrushOrgEx(hdc, 0, 0, nullptr);  // pattern row 0 on screen row 0
+        for (const auto& d : rects) {
+            PatBlt(hdc, d.left, d.top, d.right - d.left, d.bottom - d.top, ROP_DEST_AND_PATTERN);
+        }
+        SelectObject(hdc, oldBrush);
+    } else if (g_scanlineDC) {
+        BLENDFUNCTION bf = {AC_SRC_OVER, 0, 255, AC_SRC_ALPHA};
+        for (const auto& d : rects) {
+            AlphaBlend(hdc, d.left, d.top, d.right - d.left, d.bottom - d.top,
+                       g_scanlineDC, 0, d.top, 1, d.bottom - d.top, bf);
+        }
     }
 }
 
 // ─── Tail Bitmap Management ──────────────────────────────────────────────────
 
-static void CreateTailBitmap(MatrixStream& s, HDC screenDC) {
-    // Create a vertical bitmap strip for this stream's tail
-    // Width: CELL, Height: length * CELL
-    int w = CELL;
-    int h = s.length * CELL;
+static inline int TailClassFor(int length) {
+    return (length + TAIL_CLASS_ROWS - 1) / TAIL_CLASS_ROWS;
+}
+
+static inline HDC TailDC(const TailSlot& t) {
+    return g_tailClasses[t.cls].slabs[t.slot / TAIL_SLAB_SLOTS].dc;
+}
+
+static inline int TailX(const TailSlot& t) {
+    return (t.slot % TAIL_SLAB_SLOTS) * CELL;
+}
+
+static void AcquireTailSlot(const StreamSet& st, int idx) {
+    // Take a free slot of this stream's length class, adding a slab if none is
+    // left. Slabs match the back buffer, which holds a screen-compatible bitmap.
+    int cls = TailClassFor(st.length[idx]);
+    if ((int)g_tailClasses.size() <= cls) g_tailClasses.resize(cls + 1);
+    TailClass& tc = g_tailClasses[cls];
+    if (tc.freeSlots.empty()) {
+        TailSlab slab;
+        slab.dc = CreateCompatibleDC(g_memDC);
+        slab.bmp = CreateCompatibleBitmap(g_memDC, TAIL_SLAB_SLOTS * CELL, cls * TAIL_CLASS_ROWS * CELL);
+        slab.oldBmp = (HBITMAP)SelectObject(slab.dc, slab.bmp);
+        int base = (int)tc.slabs.size() * TAIL_SLAB_SLOTS;
+        tc.slabs.push_back(slab);
+        for (int i = TAIL_SLAB_SLOTS - 1; i >= 0; i--) tc.freeSlots.push_back(base + i);
+    }
+    g_tails[idx] = {cls, tc.freeSlots.back()};
+    tc.freeSlots.pop_back();
+}
 
-    s.tailDC = CreateCompatibleDC(screenDC);
-    s.tailBmp = CreateCompatibleBitmap(screenDC, w, h);
-    s.tailOldBmp = (HBITMAP)SelectObject(s.tailDC, s.tailBmp);
-    s.tailDirty = true;
+static void ReleaseTailSlot(int idx) {
+    TailSlot& t = g_tails[idx];
+    if (!t.cls) return;
+    g_tailClasses[t.cls].freeSlots.push_back(t.slot);
+    t = {0, 0};
 }
 
-static void RenderTailBitmap(MatrixStream& s) {
-    // Render the entire tail to its bitmap
+static void RenderTailBitmap(const StreamSet& st, int idx) {
+    // Render the entire tail to its slot
     // Clear to black first
-    RECT rc = {0, 0, CELL, s.length * CELL};
-    FillRect(s.tailDC, &rc, (HBRUSH)GetStockObject(BLACK_BRUSH));
+    int length = st.length[idx];
+    const wchar_t* chars = st.Chars(idx);
+    const uint8_t* colorIndices = st.TailColorIndices(idx);
+    const TailSlot& t = g_tails[idx];
+    HDC dc = TailDC(t);
+    int x = TailX(t);
+    RECT rc = {x, 0, x + CELL, length * CELL};
+    FillRect(dc, &rc, (HBRUSH)GetStockObject(BLACK_BRUSH));
 
     // Render each character from the character cache
     // Reverse order: index 0 (head/brightest) at bottom, index length-1 (tail/darkest) at top
-    for (int i = 0; i < s.length; i++) {
-        int colorIdx = s.tailColorIndices[i];
-        int charIdx = GetCharCacheIndex(s.chars[i]);
+    for (int i = 0; i < length; i++) {
+        int colorIdx = colorIndices[i];
+        int charIdx = GlyphIndex(chars[i]);
         int srcX = charIdx * CELL;
         int srcY = colorIdx * CELL;
-        int dstY = (s.length - 1 - i) * CELL;  // Reverse order in bitmap
+        int dstY = (length - 1 - i) * CELL;  // Reverse order in bitmap
 
-        // BitBlt from character cache to tail bitmap
-        BitBlt(s.tailDC, 0, dstY, CELL, CELL, 
+        // BitBlt from character cache to tail slot
+        BitBlt(dc, x, dstY, CELL, CELL,
                g_charCacheDC, srcX, srcY, SRCCOPY);
     }
+}
 
-    s.tailDirty = false;
+static void CleanupTailSlabs() {
+    for (auto& tc : g_tailClasses) {
+        for (auto& slab : tc.slabs) {
+            SelectObject(slab.dc, slab.oldBmp);
+            DeleteObject(slab.bmp);
+            DeleteDC(slab.dc);
+        }
+    }
+    g_tailClasses.clear();
+    g_tails.assign(g_tails.size(), TailSlot{0, 0});
 }
 
-static void CleanupTailBitmap(MatrixStream& s) {
-    if (s.tailDC) {
-        SelectObject(s.tailDC, s.tailOldBmp);
-        DeleteObject(s.tailBmp);
-        DeleteDC(s.tailDC);
-        s.tailDC = nullptr;
-        s.tailBmp = nullptr;
-        s.tailOldBmp = nullptr;
+// Stream respawned with a new tail
+static void OnStreamReset(const StreamSet& st, int idx) {
+    TailSlot& t = g_tails[idx];
+    if (!t.cls) return;
+    // Length class changed: trade the slot for one of the new class
+    if (TailClassFor(st.length[idx]) != t.cls) {
+        ReleaseTailSlot(idx);
+        AcquireTailSlot(st, idx);
+    }
+    RenderTailBitmap(st, idx);
+}
+
+// A single tail character mutated
+static void OnTailCharChanged(const StreamSet& st, int idx, int charIdx) {
+    // Update just this character in the tail slot
+    const TailSlot& t = g_tails[idx];
+    if (!t.cls) return;
+    int colorIdx = st.TailColorIndices(idx)[charIdx];
+    int cacheIdx = GlyphIndex(st.Chars(idx)[charIdx]);
+    int srcX = cacheIdx * CELL;
+    int srcY = colorIdx * CELL;
+    int dstY = (st.length[idx] - 1 - charIdx) * CELL;  // Reverse order to match RenderTailBitmap
+    BitBlt(TailDC(t), TailX(t), dstY, CELL, CELL, 
+           g_charCacheDC, srcX, srcY, SRCCOPY);
+}
+
+// Bring the tail slots up to date with a snapshot's respawns and glyph swaps
+static void UpdateTailSlots(const StreamSet& st) {
+    for (int i = 0; i < st.size(); i++) {
+        if (st.respawned[i]) {
+            OnStreamReset(st, i);
+        } else if (st.changedChar[i] >= 0) {
+            OnTailCharChanged(st, i, st.changedChar[i]);
+        } else if (st.changedChar[i] == SEVERAL_CHARS_CHANGED) {
+            RenderTailBitmap(st, i);
+        }
     }
 }
 
@@ -359,31 +470,28 @@ static void CleanupTailBitmap(MatrixStream& s) {
 static void InitGrid(int w, int h) {
     g_screenW  = w;
     g_screenH  = h;
-    g_gridCols = w / CELL;
-    g_gridRows = h / CELL;
+    int gridCols = w / CELL;
+    int gridRows = h / CELL;
 
     // Enumerate monitors
-    g_monitors.clear();
+    std::vector<MonitorGrid> monitors;
     if (g_targetMonitor >= 0) {
         // Single-monitor mode: origin is target monitor's pixel position
         g_virtualX = g_targetMonX;
         g_virtualY = g_targetMonY;
         // Single monitor fills the entire grid
-        g_monitors.push_back({0, 0, g_gridCols, g_gridRows});
+        monitors.push_back({0, 0, gridCols, gridRows});
     } else {
         // All monitors
         g_virtualX = GetSystemMetrics(SM_XVIRTUALSCREEN);
         g_virtualY = GetSystemMetrics(SM_YVIRTUALSCREEN);
-        EnumDisplayMonitors(nullptr, nullptr, MonitorEnumProc, 0);
+        EnumDisplayMonitors(nullptr, nullptr, MonitorEnumProc, (LPARAM)&monitors);
         // If no monitors found (e.g., preview mode), treat entire surface as one monitor
-        if (g_monitors.empty()) {
-            g_monitors.push_back({0, 0, g_gridCols, g_gridRows});
+        if (monitors.empty()) {
+            monitors.push_back({0, 0, gridCols, gridRows});
         }
     }
 
-    // init landed grid
-    g_landed.assign(g_gridRows, std::vector<LandedCell>(g_gridCols, {false, 0, 0}));
-
     // create font for matrix characters
     g_font = CreateFontW(
         CELL, 0, 0, 0, FW_BOLD, FALSE, FALSE, FALSE,
@@ -395,594 +503,364 @@ static void InitGrid(int w, int h) {
         DEFAULT_CHARSET, OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS,
         ANTIALIASED_QUALITY, FIXED_PITCH | FF_MODERN, L"Consolas");
 
-    // create streams — per-monitor: tetromino streams + tail-only streams
-    g_streams.clear();
-    for (int mi = 0; mi < (int)g_monitors.size(); mi++) {
-        auto& m = g_monitors[mi];
-        int monW = m.right - m.left;
-        int monH = m.bottom - m.top;
-        int numPieceStreams = monW;
-        if (numPieceStreams < 15) numPieceStreams = 15;
-        int numTailOnly = numPieceStreams / 2;
-        int totalStreams = numPieceStreams + numTailOnly;
-        for (int i = 0; i < totalStreams; i++) {
-            MatrixStream s;
-            s.monitorIdx = mi;
-            s.hasPiece   = (i < numPieceStreams);
-            s.col    = RandInt(m.left, m.right - 1);
-            s.y      = RandFloat((float)(m.top - 20), (float)m.top);
-            s.speed  = RandFloat(0.08f, 1.2f);
-            // Slow streams get long tails, fast streams get short tails (Matrix look)
-            int maxLen = (s.speed < 0.3f) ? monH / 2 : (s.speed < 0.6f) ? monH / 3 : monH / 5;
-            maxLen = maxLen * 5 / 4; // 25% longer tails
-            if (maxLen < 8) maxLen = 8;
-            s.length = RandInt(6, maxLen);
-            s.chars.resize(s.length);
-            for (int j = 0; j < s.length; j++) s.chars[j] = RandMatrixChar();
-            s.pieceType   = RandInt(0, 6);
-            s.rotation    = RandInt(0, 3);
-            s.pieceColor  = TETRIS_COLORS[s.pieceType];
-            s.ticksToRotate   = RandInt(10, 50);
-            s.hardDropping    = false;
-            s.origSpeed       = s.speed;
-            s.ticksToHardDrop = RandInt(200, 800);
-
-            // Initialize tail bitmap fields
-            s.tailDC = nullptr;
-            s.tailBmp = nullptr;
-            s.tailOldBmp = nullptr;
-            s.tailDirty = true;
-
-            // Pre-compute tail color gradient
-            ComputeTailColors(s);
-
-            g_streams.push_back(s);
-        }
-    }
+    // Landed grid, streams and per-monitor clear tracking; independent
+    // monitors are simulated on one thread per CPU
+    SetSimulationThreads(0);
+    InitSimulation(gridCols, gridRows, monitors, g_seed);
 
-    // Init per-monitor clear tracking
-    g_monitorClears.resize(g_monitors.size());
-    for (int i = 0; i < (int)g_monitors.size(); i++) {
-        g_monitorClears[i].monIdx = i;
-        g_monitorClears[i].phase = CLEAR_IDLE;
-        g_monitorClears[i].flashTick = 0;
-        g_monitorClears[i].dropOffset = 0.0f;
-        g_monitorClears[i].dropTarget = 0.0f;
-        g_monitorClears[i].lowestRow = -1;
-        g_monitorClears[i].highestRow = -1;
-    }
+    // Tail slots are assigned once the character cache exists (WM_CREATE)
+    g_tails.assign(g_streams.size(), TailSlot{0, 0});
 }
 
-// ─── Check if piece can land ─────────────────────────────────────────────────
+// ─── Rendering ───────────────────────────────────────────────────────────────
 
-static int GetPieceBottomRow(const MatrixStream& s) {
-    // The piece is drawn at the head of the stream
-    int headRow = (int)s.y;
-    return headRow;
+// Copy a filled cell's sprite, black border included, into the landed layer
+static void BlitLandedCell(LandedCell cell, int x, int y) {
+    BitBlt(g_landedDC, x, y, CELL, CELL, g_blockDC, cell.Palette() * CELL, cell.Glow() * CELL, SRCCOPY);
 }
 
-static bool CanPieceFitAt(int pieceType, int rotation, int gridRow, int gridCol, const MonitorGrid& mon) {
-    const auto& cells = PIECES[pieceType].cells[rotation];
-    for (int r = 0; r < 4; r++) {
-        for (int c = 0; c < 4; c++) {
-            if (!cells[r][c]) continue;
-            int gr = gridRow + r;
-            int gc = gridCol + c - 1; // center the piece on the column
-            if (gr < mon.top) continue;                    // above this monitor: skip
-            if (gc < mon.left || gc >= mon.right) continue;// off-screen sideways for this monitor: clip
-            if (gr >= mon.bottom) return false;             // below this monitor's floor
-            if (g_landed[gr][gc].filled) return false;      // hit a landed block within our monitor
-        }
-    }
-    return true;
-}
-
-static void LandPiece(MatrixStream& s) {
-    int headRow = (int)s.y;
-    int pieceCol = s.col;
-    const auto& cells = PIECES[s.pieceType].cells[s.rotation];
-    for (int r = 0; r < 4; r++) {
-        for (int c = 0; c < 4; c++) {
-            if (!cells[r][c]) continue;
-            int gr = headRow + r;
-            int gc = pieceCol + c - 1;
-            if (gr >= 0 && gr < g_gridRows && gc >= 0 && gc < g_gridCols) {
-                g_landed[gr][gc].filled     = true;
-                g_landed[gr][gc].color      = s.pieceColor;
-                g_landed[gr][gc].brightness = 255;
+// Bring the landed layer up to date with the snapshot's landings, fades,
+// clears and gravity shifts. Everything else in the layer is left untouched.
+static void UpdateLandedLayer(const SimSnapshot& snap) {
+    for (const RowBand& band : snap.changedBands) {
+        // Blank the band in one go, then copy in the cells that are filled
+        const auto& m = g_monitors[band.monIdx];
+        const LandedGrid& landed = snap.landed[band.monIdx];
+        int x0 = m.left * CELL, y0 = m.top * CELL;
+        int y = y0 + band.topRow * CELL;
+        BitBlt(g_landedDC, x0, y, landed.cols * CELL, (band.bottomRow - band.topRow + 1) * CELL,
+               g_blackDC, x0, y, SRCCOPY);
+        for (int r = band.topRow; r <= band.bottomRow; r++) {
+            const LandedCell* row = landed.Row(r);
+            for (int c = 0; c < landed.cols; c++) {
+                if (row[c].Filled()) BlitLandedCell(row[c], x0 + c * CELL, y0 + r * CELL);
             }
         }
     }
-}
-
-// Pre-compute color gradient for a tail (cached to avoid per-frame calculation)
-static void ComputeTailColors(MatrixStream& s) {
-    s.tailColors.resize(s.length);
-    s.tailColorIndices.resize(s.length);
-    for (int i = 0; i < s.length; i++) {
-        float t = (float)i / (float)s.length;
-        float exp_t = t * t; // quadratic curve
-        int colorIdx = (int)(exp_t * (NUM_GREENS - 1));
-        if (colorIdx >= NUM_GREENS) colorIdx = NUM_GREENS - 1;
-        COLORREF clr = MATRIX_GREENS[colorIdx];
-        // First few characters (head) are extra bright / near-white
-        // Use color index 0 (brightest) for these
-        if (i == 0 || i <= 2) {
-            clr = (i == 0) ? RGB(240, 255, 245) : RGB(200, 255, 215);
-            colorIdx = 0; // Use brightest cached color for heads
+    for (const CellPos& p : snap.changedCells) {
+        const auto& m = g_monitors[p.monIdx];
+        int x = (m.left + p.col) * CELL, y = (m.top + p.row) * CELL;
+        LandedCell cell = snap.landed[p.monIdx].At(p.row, p.col);
+        if (cell.Filled()) {
+            BlitLandedCell(cell, x, y);
+        } else {
+            BitBlt(g_landedDC, x, y, CELL, CELL, g_blackDC, x, y, SRCCOPY);
         }
-        s.tailColors[i] = clr;
-        s.tailColorIndices[i] = colorIdx;
     }
 }
 
-static void ResetStream(MatrixStream& s) {
-    // Respawn within same monitor, keep same stream type (piece vs tail-only)
-    auto& m = g_monitors[s.monitorIdx];
-    int monH = m.bottom - m.top;
-    s.col    = RandInt(m.left, m.right - 1);
-    s.y      = RandFloat((float)(m.top - 20), (float)(m.top - 4));
-    s.speed  = RandFloat(0.08f, 1.2f);
-    int maxLen = (s.speed < 0.3f) ? monH / 2 : (s.speed < 0.6f) ? monH / 3 : monH / 5;
-    maxLen = maxLen * 5 / 4; // 25% longer tails
-    if (maxLen < 8) maxLen = 8;
-    s.length = RandInt(6, maxLen);
-    s.chars.resize(s.length);
-    for (int j = 0; j < s.length; j++) s.chars[j] = RandMatrixChar();
-    s.pieceType       = RandInt(0, 6);
-    s.rotation        = RandInt(0, 3);
-    s.pieceColor      = TETRIS_COLORS[s.pieceType];
-    s.ticksToRotate   = RandInt(10, 50);
-    s.hardDropping    = false;
-    s.origSpeed       = s.speed;
-    s.ticksToHardDrop = RandInt(200, 800);
-
-    // Pre-compute tail color gradient
-    ComputeTailColors(s);
-
-    // Tail bitmap needs re-rendering with new length/characters
-    if (s.tailDC) {
-        // If length changed, recreate bitmap with new size
-        int oldH = 0;
-        BITMAP bm;
-        if (GetObject(s.tailBmp, sizeof(bm), &bm)) {
-            oldH = bm.bmHeight;
-        }
-        int newH = s.length * CELL;
-        if (oldH != newH) {
-            CleanupTailBitmap(s);
-            HDC screenDC = GetDC(nullptr);
-            CreateTailBitmap(s, screenDC);
-            ReleaseDC(nullptr, screenDC);
-        }
-        RenderTailBitmap(s);
-    }
+// Turn the damage accumulated since the last frame into this frame's redraw
+// rectangles, falling back to a full redraw when most of the screen changed
+static void PrepareFrameDamage() {
+    if (g_damage.DamagedFraction() > DAMAGE_FULL_REDRAW) g_damage.MarkAll();
+    g_damage.BuildRects(g_damageRects);
+    g_damagePct = g_damage.DamagedFraction() * 100.0f;
 }
 
-// ─── Row clearing ────────────────────────────────────────────────────────────
-
-static void StartClearForMonitor(MonitorClearInfo& mci) {
-    auto& m = g_monitors[mci.monIdx];
-    mci.dropOffset = 0.0f;
-    mci.lowestRow = -1;
-    mci.highestRow = -1;
-    // Search from monitor's bottom upward for rows with content
-    std::vector<int> contentRows;
-    for (int r = m.bottom - 1; r >= m.top && (int)contentRows.size() < ROWS_TO_CLEAR; r--) {
-        bool hasContent = false;
-        for (int c = m.left; c < m.right; c++) {
-            if (g_landed[r][c].filled) { hasContent = true; break; }
-        }
-        if (hasContent) {
-            contentRows.push_back(r);
-        }
-    }
-    if (contentRows.empty()) return;
-    // contentRows[0] = lowest (bottom-most), contentRows.back() = highest (top-most)
-    mci.lowestRow  = contentRows[0];
-    mci.highestRow = contentRows.back();
-    // Build the full contiguous span from highestRow to lowestRow
-    mci.rows.clear();
-    for (int r = mci.highestRow; r <= mci.lowestRow; r++) {
-        mci.rows.push_back(r);
-    }
-    int span = mci.lowestRow - mci.highestRow + 1;
-    mci.dropTarget = (float)(span * CELL);
-    mci.phase = CLEAR_FLASH;
-    mci.flashTick = 20;
+static void TailSource(int si, void*& src, int& srcX) {
+    src = TailDC(g_tails[si]);
+    srcX = TailX(g_tails[si]);
 }
 
-static void ApplyClearAndStartDrop(MonitorClearInfo& mci) {
-    // Clear the marked rows within this monitor
-    auto& m = g_monitors[mci.monIdx];
-    for (int r : mci.rows) {
-        for (int c = m.left; c < m.right; c++) {
-            g_landed[r][c] = {false, 0, 0};
+static void Render(HDC hdc, const SimSnapshot& snap, const std::vector<PixelRect>& rects, bool scanlines) {
+    if (rects.empty()) return;
+
+    // Restrict all drawing to the damaged rectangles
+    HRGN clipRgn;
+    {
+        ProfileScope prof(PROF_CLEAR);
+        clipRgn = CreateRectRgn(0, 0, 0, 0);
+        for (const auto& d : rects) {
+            HRGN rectRgn = CreateRectRgn(d.left, d.top, d.right, d.bottom);
+            CombineRgn(clipRgn, clipRgn, rectRgn, RGN_OR);
+            DeleteObject(rectRgn);
         }
+        SelectClipRgn(hdc, clipRgn);
     }
-    mci.dropOffset = 0.0f;
-    mci.phase = CLEAR_DROP;
+
+    // The frame is recorded into g_drawList and drawn in one go
+    RecordFrame(g_drawList, snap, rects, g_damage, {g_landedDC, g_blackDC, g_blockDC, TailSource});
+    SubmitDrawList(hdc, g_drawList, g_gdiObjects);
+
+    // ── Scanline overlay for CRT effect ──────────────────────────────────
+    ProfileScope prof(PROF_SCANLINES);
+    if (scanlines) ApplyScanlines(hdc, rects);
+
+    SelectClipRgn(hdc, nullptr);
+    DeleteObject(clipRgn);
 }
 
-static void ApplyGravityForMonitor(const MonitorGrid& m, int numRows) {
-    // Structure-preserving shift: move all rows above the cleared zone
-    // down by numRows, keeping their relative positions intact.
-    // Shift from bottom to top to avoid overwriting.
-    // Find the topmost row that has content within this monitor
-    int topContent = m.bottom;
-    for (int r = m.top; r < m.bottom; r++) {
-        for (int c = m.left; c < m.right; c++) {
-            if (g_landed[r][c].filled) { topContent = r; goto found; }
-        }
-    }
-    found:
-    // Shift rows down by numRows
-    for (int r = m.bottom - 1; r >= topContent + numRows; r--) {
-        int src = r - numRows;
-        for (int c = m.left; c < m.right; c++) {
-            g_landed[r][c] = g_landed[src][c];
-        }
+// ─── Renderer backends ───────────────────────────────────────────────────────
+
+// GDI drawing into the compatible back buffer (g_memDC). Blocks come from
+// pre-rendered sprites, so bevels cost nothing and are always drawn.
+class GdiRenderer : public Renderer {
+public:
+    void AfterTick(const SimSnapshot& snap) override {
+        ProfileScope prof(PROF_TAILS);
+        UpdateTailSlots(snap.streams);
+        prof.Switch(PROF_LANDED);
+        UpdateLandedLayer(snap);
     }
-    // Clear the top numRows rows that were vacated
-    for (int r = topContent; r < topContent + numRows && r < m.bottom; r++) {
-        for (int c = m.left; c < m.right; c++) {
-            g_landed[r][c] = {false, 0, 0};
-        }
+    void RenderFrame(const SimSnapshot& snap, const std::vector<PixelRect>& rects) override {
+        Render(g_memDC, snap, rects, scanlines.Enabled());
     }
-}
+};
 
-// ─── Fill-level tracking ─────────────────────────────────────────────────────
+static GdiRenderer      g_gdiRenderer;
+static SoftwareRenderer g_softRenderer;  // draws straight into the DIB section behind g_memDC
+static Renderer*        g_renderer = &g_gdiRenderer;
+
+// Rasterize every tail glyph once with the GDI font into the software
+// renderer's coverage atlas
+static void BuildGdiGlyphAtlas(HDC screenDC, GlyphAtlas& atlas) {
+    int h = NUM_GLYPHS * CELL;
+    BITMAPINFO bi = {};
+    bi.bmiHeader.biSize        = sizeof(bi.bmiHeader);
+    bi.bmiHeader.biWidth       = CELL;
+    bi.bmiHeader.biHeight      = -h;  // top-down
+    bi.bmiHeader.biPlanes      = 1;
+    bi.bmiHeader.biBitCount    = 32;
+    bi.bmiHeader.biCompression = BI_RGB;
+    void* bits = nullptr;
+    HDC dc = CreateCompatibleDC(screenDC);
+    HBITMAP bmp = CreateDIBSection(dc, &bi, DIB_RGB_COLORS, &bits, nullptr, 0);
+    HBITMAP oldBmp = (HBITMAP)SelectObject(dc, bmp);
+    RECT rc = {0, 0, CELL, h};
+    FillRect(dc, &rc, (HBRUSH)GetStockObject(BLACK_BRUSH));
+    SetBkMode(dc, TRANSPARENT);
+    SetTextColor(dc, RGB(255, 255, 255));
+    HFONT oldFont = (HFONT)SelectObject(dc, g_font);
+    for (int g = 0; g < GLYPH_BLANK; g++) {
+        wchar_t str[2] = {GLYPH_CHARS[g], 0};
+        TextOutW(dc, 0, g * CELL, str, 1);
+    }
+    GdiFlush();
 
-static float GetMonitorFillPct(const MonitorGrid& m) {
-    int monH = m.bottom - m.top;
-    if (monH <= 0) return 0.0f;
-    int filledRows = 0;
-    for (int r = m.top; r < m.bottom; r++) {
-        for (int c = m.left; c < m.right; c++) {
-            if (g_landed[r][c].filled) { filledRows++; break; }
-        }
+    // White-on-black text: any channel is the glyph's coverage
+    atlas.coverage.resize((size_t)NUM_GLYPHS * CELL * CELL);
+    const Pixel* px = (const Pixel*)bits;
+    for (size_t i = 0; i < atlas.coverage.size(); i++) {
+        atlas.coverage[i] = (uint8_t)((px[i] >> 8) & 0xFF);
     }
-    return (float)filledRows / (float)monH;
+
+    SelectObject(dc, oldFont);
+    SelectObject(dc, oldBmp);
+    DeleteObject(bmp);
+    DeleteDC(dc);
 }
 
-// ─── Update ──────────────────────────────────────────────────────────────────
+// ─── Profiler overlay ────────────────────────────────────────────────────────
 
-static void Update() {
-    // ── Per-monitor row clearing state machine ────────────────────────
-    DWORD now = GetTickCount();
+static wchar_t   g_statsText[1024];
+static PixelRect g_statsRect = {0, 0, 0, 0};  // where the overlay was last drawn
+static LONGLONG  g_nextStatsRefresh = 0;
 
-    for (auto& mci : g_monitorClears) {
-        if (mci.phase == CLEAR_IDLE) {
-            // Check if this monitor has reached the fill threshold
-            float fillPct = GetMonitorFillPct(g_monitors[mci.monIdx]);
-            if (fillPct >= FILL_CLEAR_PCT) {
-                StartClearForMonitor(mci);
-            }
-        } else if (mci.phase == CLEAR_FLASH) {
-            mci.flashTick--;
-            if (mci.flashTick <= 0) {
-                ApplyClearAndStartDrop(mci);
-            }
-        } else if (mci.phase == CLEAR_DROP) {
-            if (mci.dropOffset < mci.dropTarget) {
-                float dropSpeed = 3.0f + mci.dropOffset * 0.05f;
-                mci.dropOffset += dropSpeed;
-                if (mci.dropOffset >= mci.dropTarget) {
-                    mci.dropOffset = mci.dropTarget;
-                    ApplyGravityForMonitor(g_monitors[mci.monIdx], (int)mci.rows.size());
-                    mci.phase = CLEAR_IDLE;
-                }
-            } else {
-                mci.phase = CLEAR_IDLE;
-            }
-        }
+// Rebuild the overlay text from the profiler's rolling window and size its
+// box in the first monitor's top-left corner
+static void RefreshStatsOverlay() {
+    int n = swprintf(g_statsText, 1024, L"phase        p50    p95    p99  (us)\n");
+    for (int p = 0; p < PROF_NUM_PHASES && n > 0; p++) {
+        ProfileStats s = g_profiler.Stats((ProfilePhase)p);
+        n += swprintf(g_statsText + n, 1024 - n, L"%-10hs %6.0f %6.0f %6.0f\n",
+                      Profiler::PhaseName((ProfilePhase)p), s.p50, s.p95, s.p99);
+    }
+    if (n > 0) {
+        n += swprintf(g_statsText + n, 1024 - n, L"%llu ticks, %llu dropped, %llu reused, %.0f%% redrawn",
+                      (unsigned long long)g_snapshots.Published(), (unsigned long long)g_snapshots.Dropped(),
+                      (unsigned long long)g_snapshots.Reused(), g_damagePct);
+    }
+    if (n > 0 && g_governor.Budget() > 0) {
+        n += swprintf(g_statsText + n, 1024 - n, L"\nquality tier %d of %d, %.1f ms per frame (budget %.1f)",
+                      g_governor.Tier(), NUM_QUALITY_TIERS - 1, g_governor.Cost() / 1e6, g_governor.Budget() / 1e6);
+    }
+    if (n > 0 && g_renderer == &g_gdiRenderer) {
+        swprintf(g_statsText + n, 1024 - n, L"\n%d GDI commands, %d state changes",
+                 g_drawList.Commands(), g_drawList.StateChanges());
     }
 
-    // ── Update streams ───────────────────────────────────────────────
-    for (auto& s : g_streams) {
-        // Check if this stream's monitor is currently clearing
-        bool monitorClearing = false;
-        if (s.monitorIdx < (int)g_monitorClears.size()) {
-            monitorClearing = (g_monitorClears[s.monitorIdx].phase != CLEAR_IDLE);
-        }
-        float speedMul = monitorClearing ? 0.20f : 1.0f;
-
-        // Rotation timer — only for piece streams
-        if (s.hasPiece) {
-            s.ticksToRotate--;
-            if (s.ticksToRotate <= 0) {
-                int newRot = (s.rotation + RandInt(1, 3)) % 4;
-                if (CanPieceFitAt(s.pieceType, newRot, (int)s.y, s.col, g_monitors[s.monitorIdx])) {
-                    s.rotation = newRot;
-                }
-                s.ticksToRotate = RandInt(10, 50);
-            }
+    RECT rc = {0, 0, 0, 0};
+    HFONT oldFont = (HFONT)SelectObject(g_memDC, g_fontSmall);
+    DrawTextW(g_memDC, g_statsText, -1, &rc, DT_CALCRECT | DT_NOPREFIX);
+    SelectObject(g_memDC, oldFont);
+    const auto& m = g_monitors[0];
+    int x = m.left * CELL + CELL, y = m.top * CELL + CELL;
+    g_statsRect = {x, y, std::min(x + (int)rc.right + 8, g_screenW), std::min(y + (int)rc.bottom + 8, g_screenH)};
+}
 
-            // Hard drop trigger
-            if (!s.hardDropping) {
-                s.ticksToHardDrop--;
-                if (s.ticksToHardDrop <= 0) {
-                    s.hardDropping = true;
-                    s.origSpeed = s.speed;
-                    s.speed = RandFloat(1.5f, 5.0f); // very fast
-                }
-            }
-        }
+// Draw the overlay over the finished frame. Its box is damaged every frame,
+// so the scene beneath is redrawn first.
+static void DrawStatsOverlay(HDC hdc) {
+    RECT rc = {g_statsRect.left, g_statsRect.top, g_statsRect.right, g_statsRect.bottom};
+    FillRect(hdc, &rc, (HBRUSH)GetStockObject(BLACK_BRUSH));
+    InflateRect(&rc, -4, -4);
+    HFONT oldFont = (HFONT)SelectObject(hdc, g_fontSmall);
+    SetBkMode(hdc, TRANSPARENT);
+    SetTextColor(hdc, RGB(120, 255, 140));
+    DrawTextW(hdc, g_statsText, -1, &rc, DT_NOPREFIX | DT_NOCLIP);
+    SelectObject(hdc, oldFont);
+    // The software renderer writes the DIB directly next frame
+    GdiFlush();
+}
 
-        // Move — step row by row so fast pieces can't skip through blocks
-        float newY = s.y + s.speed * speedMul;
-        int startRow = (int)s.y;
-        int endRow   = (int)newY;
-        bool landed  = false;
-
-        // Randomly change a character in the tail
-        if (rand() % 5 == 0 && s.chars.size() > 0) {
-            int idx = rand() % s.chars.size();
-            s.chars[idx] = RandMatrixChar();
-
-            // Update just this character in the tail bitmap
-            if (s.tailDC) {
-                int colorIdx = s.tailColorIndices[idx];
-                int charIdx = GetCharCacheIndex(s.chars[idx]);
-                int srcX = charIdx * CELL;
-                int srcY = colorIdx * CELL;
-                int dstY = (s.length - 1 - idx) * CELL;  // Reverse order to match RenderTailBitmap
-                BitBlt(s.tailDC, 0, dstY, CELL, CELL, 
-                       g_charCacheDC, srcX, srcY, SRCCOPY);
-            }
-        }
+// ─── Threads ─────────────────────────────────────────────────────────────────
 
-        // Tail-only streams: just move and wrap, no collision
-        if (!s.hasPiece) {
-            s.y = newY;
-            const auto& mon = g_monitors[s.monitorIdx];
-            if ((int)s.y - s.length > mon.bottom + 10) {
-                ResetStream(s);
-            }
-            continue;
-        }
+static LONGLONG TickQpc() {
+    return (LONGLONG)(g_tickMs * (double)g_qpcFreq.QuadPart / 1000.0);
+}
 
-        // ── Collision detection: step through each row ───────────────
-        const auto& mon = g_monitors[s.monitorIdx];
-        if (endRow >= -3) {
-            // Make sure we check from at least startRow
-            int checkFrom = (startRow < -3) ? -3 : startRow;
-            int landRow = -999;
-            for (int testRow = checkFrom; testRow <= endRow; testRow++) {
-                if (!CanPieceFitAt(s.pieceType, s.rotation, testRow, s.col, mon)) {
-                    landRow = testRow - 1;  // last row that fit
-                    break;
-                }
-            }
-            if (landRow != -999) {
-                // Land the piece at the last valid row
-                if (landRow >= -3) {
-                    s.y = (float)landRow;
-                    bool anyOnScreen = false;
-                    const auto& pcells = PIECES[s.pieceType].cells[s.rotation];
-                    for (int r = 0; r < 4; r++)
-                        for (int c2 = 0; c2 < 4; c2++)
-                            if (pcells[r][c2] && landRow + r >= 0 && landRow + r < g_gridRows)
-                                anyOnScreen = true;
-                    if (anyOnScreen) LandPiece(s);
-                }
-                ResetStream(s);
-                continue;
-            }
-        }
-        s.y = newY;
+// Sleep until the QPC deadline, or briefly if it is (nearly) here
+static void SleepUntil(LONGLONG deadline, LONGLONG now) {
+    Sleep((DWORD)((deadline - now) * 1000 / g_qpcFreq.QuadPart));
+}
 
-        // If stream has gone fully off screen (past its monitor's floor)
-        if ((int)s.y - s.length > mon.bottom + 10) {
-            ResetStream(s);
+// Fixed-timestep simulation: one Update() per tick, each published as a
+// snapshot stamped with the tick's scheduled time
+static void SimThreadMain() {
+    LONGLONG tickQpc = TickQpc();
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    LONGLONG nextTick = now.QuadPart + tickQpc;
+    int tier = -1;
+    while (!g_stopThreads.load(std::memory_order_relaxed)) {
+        QueryPerformanceCounter(&now);
+        if (now.QuadPart < nextTick) {
+            SleepUntil(nextTick, now.QuadPart);
+            continue;
         }
-    }
-
-    // Fade brightness of landed cells
-    for (int r = 0; r < g_gridRows; r++) {
-        for (int c = 0; c < g_gridCols; c++) {
-            if (g_landed[r][c].brightness > 80) {
-                g_landed[r][c].brightness -= 3;
-            }
+        // The governor's stream settings only change between ticks
+        if (g_governor.Tier() != tier) {
+            tier = g_governor.Tier();
+            SetStreamQuality(QUALITY_TIERS[tier].tailStreamShare, QUALITY_TIERS[tier].maxTailLength);
         }
+        // Too far behind (suspend, debugger, slow machine): drop the backlog
+        // instead of spiralling
+        if (now.QuadPart - nextTick > MAX_CATCHUP_TICKS * tickQpc) nextTick = now.QuadPart;
+        int64_t start = Profiler::Now();
+        Update();
+        g_snapshots.Publish(nextTick);
+        g_governor.AddTick(Profiler::Now() - start);
+        g_profiler.EndTick();
+        nextTick += tickQpc;
     }
 }
 
-// ─── Rendering ───────────────────────────────────────────────────────────────
-
-static COLORREF DimColor(COLORREF base, int brightness) {
-    int rr = GetRValue(base) * brightness / 255;
-    int gg = GetGValue(base) * brightness / 255;
-    int bb = GetBValue(base) * brightness / 255;
-    return RGB(rr, gg, bb);
+// The governor changed tier: switch the renderer's effects and redraw
+// everything in the new style. The GDI renderer ignores bevels: its sprites
+// cost the same either way, so only its scanlines go.
+static void ApplyRenderQuality() {
+    const QualitySettings& q = g_governor.Settings();
+    g_renderer->scanlines = q.effects ? g_scanlines : ScanlineSettings{0, 0};
+    g_renderer->bevels = q.effects;
+    g_damage.MarkAll();
 }
 
-static void Render(HDC hdc) {
-    // Clear to black using BitBlt from pre-filled black bitmap (faster than FillRect)
-    BitBlt(hdc, 0, 0, g_screenW, g_screenH, g_blackDC, 0, 0, SRCCOPY);
-
-    SetBkMode(hdc, TRANSPARENT);
-    HFONT oldFont = (HFONT)SelectObject(hdc, g_font);
-
-    // ── Draw landed Tetris blocks ────────────────────────────────────────
-    // Cache for brush/pen to avoid recreating identical colors
-    HBRUSH cachedBr = nullptr;
-    COLORREF cachedBrColor = 0xFFFFFFFF;
-    HPEN cachedPen = nullptr;
-    COLORREF cachedPenColor = 0xFFFFFFFF;
-
-    for (int r = 0; r < g_gridRows; r++) {
-        for (int c = 0; c < g_gridCols; c++) {
-            if (!g_landed[r][c].filled) continue;
-            int x = c * CELL;
-            int y = r * CELL;
-
-            // During drop animation, shift cells above cleared zone per-monitor
-            for (auto& mci : g_monitorClears) {
-                if (mci.phase != CLEAR_DROP) continue;
-                auto& m = g_monitors[mci.monIdx];
-                if (c >= m.left && c < m.right && r >= m.top && r < mci.highestRow) {
-                    y += (int)mci.dropOffset;
-                    if (y >= m.bottom * CELL) goto skip_cell;
-                    break;
-                }
-            }
-
-            {
-                COLORREF col = DimColor(g_landed[r][c].color, g_landed[r][c].brightness);
-                COLORREF penColor = DimColor(RGB(150, 255, 180), g_landed[r][c].brightness / 2);
-
-                // Reuse brush if same color
-                if (col != cachedBrColor) {
-                    if (cachedBr) DeleteObject(cachedBr);
-                    cachedBr = CreateSolidBrush(col);
-                    cachedBrColor = col;
-                }
-                RECT rc = {x + 1, y + 1, x + CELL - 1, y + CELL - 1};
-                FillRect(hdc, &rc, cachedBr);
-
-                // Reuse pen if same color
-                if (penColor != cachedPenColor) {
-                    if (cachedPen) DeleteObject(cachedPen);
-                    cachedPen = CreatePen(PS_SOLID, 1, penColor);
-                    cachedPenColor = penColor;
-                }
-                HPEN oldPen = (HPEN)SelectObject(hdc, cachedPen);
-                MoveToEx(hdc, x + 1, y + 1, nullptr);
-                LineTo(hdc, x + CELL - 2, y + 1);
-                MoveToEx(hdc, x + 1, y + 1, nullptr);
-                LineTo(hdc, x + 1, y + CELL - 2);
-                SelectObject(hdc, oldPen);
-            }
-            skip_cell:;
-        }
+// Draw the newest snapshot and present the damaged rectangles
+static void DrawFrame(HWND hWnd, LONGLONG now, LONGLONG tickQpc) {
+    if (g_snapshots.Acquire()) {
+        g_renderer->AfterTick(g_snapshots.Front());
+        TrackTickDamage(g_damage, g_snapshots.Front());
     }
-    // Clean up cached objects
-    if (cachedBr) DeleteObject(cachedBr);
-    if (cachedPen) DeleteObject(cachedPen);
-
-    // ── Flash animation for cleared rows (per-monitor) ───────────────────
-    for (auto& mci : g_monitorClears) {
-        if (mci.phase != CLEAR_FLASH) continue;
-        int alpha = mci.flashTick * 12;
-        if (alpha > 255) alpha = 255;
-        HBRUSH flashBr = CreateSolidBrush(RGB(0, alpha, alpha / 3));
-        auto& m = g_monitors[mci.monIdx];
-        for (int row : mci.rows) {
-            RECT rc = {m.left * CELL, row * CELL, m.right * CELL, (row + 1) * CELL};
-            FillRect(hdc, &rc, flashBr);
+    SimSnapshot& snap = g_snapshots.Front();
+    float alpha = (float)(now - snap.stamp) / (float)tickQpc;
+    snap.Interpolate(std::min(std::max(alpha, 0.0f), 1.0f));
+    TrackFrameDamage(g_damage, snap);
+    if (g_showStats) {
+        // Old and new overlay boxes both need the scene redrawn under them
+        if (now >= g_nextStatsRefresh) {
+            g_damage.Add(g_statsRect);
+            RefreshStatsOverlay();
+            g_nextStatsRefresh = now + STATS_REFRESH_MS * g_qpcFreq.QuadPart / 1000;
         }
-        DeleteObject(flashBr);
+        g_damage.Add(g_statsRect);
     }
-
-    // ── Draw Matrix streams and Tetris pieces ────────────────────────────
-    for (const auto& s : g_streams) {
-        int headRow = (int)s.y;
-
-        // Find the topmost filled row of the piece so the tail connects snugly
-        int pieceTopRow = 4; // default: no piece/cells found
-        if (s.hasPiece) {
-            const auto& cells = PIECES[s.pieceType].cells[s.rotation];
-            for (int r = 0; r < 4; r++) {
-                for (int c = 0; c < 4; c++) {
-                    if (cells[r][c]) { pieceTopRow = r; goto found_top; }
-                }
-            }
-            found_top:;
+    PrepareFrameDamage();
+    g_renderer->RenderFrame(snap, g_damageRects);
+    if (g_showStats) DrawStatsOverlay(g_memDC);
+    // Everything damaged is now up to date in the back buffer
+    g_damage.Clear();
+
+    ProfileScope prof(PROF_PRESENT);
+    HDC hdc = GetDC(hWnd);
+    if (g_presentAll.exchange(false)) {
+        BitBlt(hdc, 0, 0, g_screenW, g_screenH, g_memDC, 0, 0, SRCCOPY);
+    } else {
+        for (const auto& d : g_damageRects) {
+            BitBlt(hdc, d.left, d.top, d.right - d.left, d.bottom - d.top, g_memDC, d.left, d.top, SRCCOPY);
         }
+    }
+    ReleaseDC(hWnd, hdc);
+}
 
-        // Clip rendering to this stream's monitor
-        const auto& mon = g_monitors[s.monitorIdx];
-
-        // Draw character tail using pre-rendered tail bitmap
-        // Single TransparentBlt for entire tail (black pixels are transparent)
-        // Tail grows UPWARD from the head, so we need to calculate the top of the tail
-        int tailStartRow = s.hasPiece ? (headRow + pieceTopRow - 1) : headRow;
-        int dstX = s.col * CELL;
-        int tailHeight = s.length * CELL;
-        // Tail extends upward, so start from (tailStartRow - length + 1)
-        int dstY = (tailStartRow - s.length + 1) * CELL;
-
-        // Clip tail to monitor boundaries
-        int srcY = 0;
-        int clipTop = mon.top * CELL;
-        int clipBottom = mon.bottom * CELL;
-
-        if (dstY < clipTop) {
-            // Tail extends above monitor - clip top portion
-            int clipAmount = clipTop - dstY;
-            srcY = clipAmount;
-            tailHeight -= clipAmount;
-            dstY = clipTop;
-        }
-        if (dstY + tailHeight > clipBottom) {
-            // Tail extends below monitor - clip bottom portion
-            tailHeight = clipBottom - dstY;
+// Frames at display rate: right after the previous one when vsync paces us
+// through DwmFlush, otherwise on a high-resolution schedule
+static void RenderThreadMain(HWND hWnd) {
+    LONGLONG tickQpc = TickQpc();
+    LONGLONG period = g_qpcFreq.QuadPart / (g_targetFps > 0 ? g_targetFps : FALLBACK_FPS);
+    LONGLONG nextFrame = 0;
+    LONGLONG nextReport = 0;
+    LONGLONG nextCsv = 0, csvStart = 0;
+    uint64_t frames = 0;
+    FILE* csv = nullptr;
+    if (g_profilePath[0] && (csv = _wfopen(g_profilePath, L"w")) != nullptr) Profiler::WriteCsvHeader(csv);
+    while (!g_stopThreads.load(std::memory_order_relaxed)) {
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+        if (now.QuadPart < nextFrame) {
+            SleepUntil(nextFrame, now.QuadPart);
+            continue;
         }
-
-        // Only draw if visible
-        if (tailHeight > 0 && dstX >= mon.left * CELL && dstX < mon.right * CELL) {
-            // Use TransparentBlt with black as transparent color so tails can overlap
-            TransparentBlt(hdc, dstX, dstY, CELL, tailHeight,
-                           s.tailDC, 0, srcY, CELL, tailHeight,
-                           RGB(0, 0, 0));  // Black is transparent
+        int64_t start = Profiler::Now();
+        DrawFrame(hWnd, now.QuadPart, tickQpc);
+        g_profiler.EndFrame();
+        if (g_governor.AddFrame(Profiler::Now() - start)) ApplyRenderQuality();
+        frames++;
+
+        if (csv && now.QuadPart >= nextCsv) {
+            if (nextCsv) {
+                g_profiler.WriteCsvRows(csv, (double)(now.QuadPart - csvStart) / g_qpcFreq.QuadPart);
+            } else {
+                csvStart = now.QuadPart;
+            }
+            nextCsv = now.QuadPart + PROFILE_CSV_SECONDS * g_qpcFreq.QuadPart;
         }
 
-        // Skip piece drawing for tail-only streams
-        if (!s.hasPiece) continue;
-
-        // Draw Tetris piece at head position
-        const auto& cells = PIECES[s.pieceType].cells[s.rotation];
-        HPEN oldPP = (HPEN)SelectObject(hdc, g_highlightPen);
-
-        // Create brushes/pens once per piece instead of per cell
-        COLORREF pc = s.pieceColor;
-        HBRUSH pieceBr = CreateSolidBrush(pc);
-        HPEN shadowPen = CreatePen(PS_SOLID, 1, DimColor(pc, 100));
-
-        for (int r = 0; r < 4; r++) {
-            for (int c = 0; c < 4; c++) {
-                if (!cells[r][c]) continue;
-                int gr = headRow + r;
-                int gc = s.col + c - 1;
-                if (gr < mon.top || gr >= mon.bottom || gc < mon.left || gc >= mon.right) continue;
-
-                int px = gc * CELL;
-                int py = gr * CELL;
-
-                RECT prc = {px + 1, py + 1, px + CELL - 1, py + CELL - 1};
-                FillRect(hdc, &prc, pieceBr);
-
-                // Bright edge (cached pen)
-                MoveToEx(hdc, px + 1, py + 1, nullptr);
-                LineTo(hdc, px + CELL - 2, py + 1);
-                MoveToEx(hdc, px + 1, py + 1, nullptr);
-                LineTo(hdc, px + 1, py + CELL - 2);
-
-                // Shadow edge
-                SelectObject(hdc, shadowPen);
-                MoveToEx(hdc, px + CELL - 2, py + 1, nullptr);
-                LineTo(hdc, px + CELL - 2, py + CELL - 2);
-                MoveToEx(hdc, px + 1, py + CELL - 2, nullptr);
-                LineTo(hdc, px + CELL - 2, py + CELL - 2);
-                SelectObject(hdc, g_highlightPen);
+        // Dropped snapshots mean rendering can't keep up with the
+        // simulation; reused ones that the simulation can't keep up with the
+        // display (expected when the frame rate is above the tick rate)
+        if (now.QuadPart >= nextReport) {
+            if (nextReport) {
+                wchar_t line[160];
+                swprintf(line, 160, L"MatrixTetris: %llu frames, %llu ticks, %llu snapshots dropped, %llu frames reused a snapshot\n",
+                         (unsigned long long)frames, (unsigned long long)g_snapshots.Published(),
+                         (unsigned long long)g_snapshots.Dropped(), (unsigned long long)g_snapshots.Reused());
+                OutputDebugStringW(line);
             }
+            nextReport = now.QuadPart + STATS_REPORT_SECONDS * g_qpcFreq.QuadPart;
         }
 
-        DeleteObject(pieceBr);
-        DeleteObject(shadowPen);
-        SelectObject(hdc, oldPP);
+        // DwmFlush blocks until the next composition; it fails when
+        // composition is off, and the timer takes over
+        if (g_targetFps == 0 && SUCCEEDED(DwmFlush())) continue;
+        nextFrame += period;
+        if (nextFrame < now.QuadPart) nextFrame = now.QuadPart + period;
     }
+    if (csv) fclose(csv);
+}
 
-    SelectObject(hdc, oldFont);
+static void StartThreads(HWND hWnd) {
+    timeBeginPeriod(1);  // millisecond Sleep() for both schedules
+    g_stopThreads = false;
+    g_simThread = std::thread(SimThreadMain);
+    g_renderThread = std::thread(RenderThreadMain, hWnd);
+}
 
-    // ── Scanline overlay for CRT effect ──────────────────────────────────
-    HPEN oldScanPen = (HPEN)SelectObject(hdc, g_scanlinePen);
-    for (int yy = 0; yy < g_screenH; yy += 3) {
-        MoveToEx(hdc, 0, yy, nullptr);
-        LineTo(hdc, g_screenW, yy);
-    }
-    SelectObject(hdc, oldScanPen);
+static void StopThreads() {
+    if (!g_simThread.joinable()) return;
+    g_stopThreads = true;
+    g_simThread.join();
+    g_renderThread.join();
+    timeEndPeriod(1);
 }
 
 // ─── Window Procedure ────────────────────────────────────────────────────────
@@ -996,53 +874,85 @@ static LRESULT CALLBACK ScreenSaverProc(HWND hWnd, UINT msg, WPARAM wParam, LPAR
 
         RECT rc;
         GetClientRect(hWnd, &rc);
-        srand((unsigned)time(nullptr));
+        if (!g_fixedSeed) g_seed = (uint32_t)time(nullptr);
         InitGrid(rc.right, rc.bottom);
 
+        // The initial state is the first snapshot; caches are built from it
+        QueryPerformanceFrequency(&g_qpcFreq);
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+        g_snapshots.Publish(now.QuadPart);
+        g_snapshots.Acquire();
+        const SimSnapshot& snap = g_snapshots.Front();
+
         // Create persistent double-buffer
         HDC screenDC = GetDC(hWnd);
         g_memDC  = CreateCompatibleDC(screenDC);
-        g_memBmp = CreateCompatibleBitmap(screenDC, g_screenW, g_screenH);
+        if (g_softwareRender) {
+            // Software renderer draws straight into a top-down 32bpp DIB
+            BITMAPINFO bi = {};
+            bi.bmiHeader.biSize        = sizeof(bi.bmiHeader);
+            bi.bmiHeader.biWidth       = g_screenW;
+            bi.bmiHeader.biHeight      = -g_screenH;
+            bi.bmiHeader.biPlanes      = 1;
+            bi.bmiHeader.biBitCount    = 32;
+            bi.bmiHeader.biCompression = BI_RGB;
+            void* bits = nullptr;
+            g_memBmp = CreateDIBSection(screenDC, &bi, DIB_RGB_COLORS, &bits, nullptr, 0);
+            g_softRenderer.fb.Attach((Pixel*)bits, g_screenW, g_screenH, g_screenW);
+            BuildGdiGlyphAtlas(screenDC, g_softRenderer.atlas);
+            g_renderer = &g_softRenderer;
+        } else {
+            g_memBmp = CreateCompatibleBitmap(screenDC, g_screenW, g_screenH);
+        }
         g_oldBmp = (HBITMAP)SelectObject(g_memDC, g_memBmp);
 
-        // Create character cache
-        CreateCharacterCache(screenDC);
+        if (!g_softwareRender) {
+            // Create character cache, block sprites and scanline mask
+            CreateCharacterCache(screenDC);
+            CreateBlockSprites(screenDC);
+            CreateScanlineMask(screenDC);
 
-        // Create tail bitmaps for all streams
-        for (auto& s : g_streams) {
-            CreateTailBitmap(s, screenDC);
-            RenderTailBitmap(s);
-        }
+            // Give every stream a tail slot
+            for (int i = 0; i < snap.streams.size(); i++) {
+                AcquireTailSlot(snap.streams, i);
+                RenderTailBitmap(snap.streams, i);
+            }
 
-        // Create pre-filled black bitmap for fast screen clearing
-        g_blackDC = CreateCompatibleDC(screenDC);
-        g_blackBmp = CreateCompatibleBitmap(screenDC, g_screenW, g_screenH);
-        g_blackOldBmp = (HBITMAP)SelectObject(g_blackDC, g_blackBmp);
-        RECT rcBlack = {0, 0, g_screenW, g_screenH};
-        FillRect(g_blackDC, &rcBlack, (HBRUSH)GetStockObject(BLACK_BRUSH));
+            // Create pre-filled black bitmap for fast screen clearing
+            g_blackDC = CreateCompatibleDC(screenDC);
+            g_blackBmp = CreateCompatibleBitmap(screenDC, g_screenW, g_screenH);
+            g_blackOldBmp = (HBITMAP)SelectObject(g_blackDC, g_blackBmp);
+            RECT rcBlack = {0, 0, g_screenW, g_screenH};
+            FillRect(g_blackDC, &rcBlack, (HBRUSH)GetStockObject(BLACK_BRUSH));
+
+            // Landed layer starts out empty (black)
+            g_landedDC = CreateCompatibleDC(screenDC);
+            g_landedBmp = CreateCompatibleBitmap(screenDC, g_screenW, g_screenH);
+            g_landedOldBmp = (HBITMAP)SelectObject(g_landedDC, g_landedBmp);
+            BitBlt(g_landedDC, 0, 0, g_screenW, g_screenH, g_blackDC, 0, 0, SRCCOPY);
+        }
 
         ReleaseDC(hWnd, screenDC);
+        g_renderer->scanlines = g_scanlines;
 
-        // Cache pens
-        g_highlightPen = CreatePen(PS_SOLID, 1, RGB(200, 255, 220));
-        g_scanlinePen  = CreatePen(PS_SOLID, 1, RGB(0, 0, 0));
+        // First frame draws everything
+        g_damage.Reset(g_screenW, g_screenH);
 
-        SetTimer(hWnd, TIMER_ID, FRAME_MS, nullptr);
+        // The governor only lowers quality when /budget asks for it
+        g_governor.Reset((int64_t)(g_frameBudgetMs * 1e6));
+
+        StartThreads(hWnd);
         return 0;
     }
-    case WM_TIMER:
-        if (wParam == TIMER_ID) {
-            Update();
-            InvalidateRect(hWnd, nullptr, FALSE);
-        }
-        return 0;
 
     case WM_PAINT: {
+        // The back buffer belongs to the render thread, which presents all
+        // of it with its next frame
         PAINTSTRUCT ps;
-        HDC hdc = BeginPaint(hWnd, &ps);
-        Render(g_memDC);
-        BitBlt(hdc, 0, 0, g_screenW, g_screenH, g_memDC, 0, 0, SRCCOPY);
+        BeginPaint(hWnd, &ps);
         EndPaint(hWnd, &ps);
+        g_presentAll = true;
         return 0;
     }
 
@@ -1066,7 +976,8 @@ static LRESULT CALLBACK ScreenSaverProc(HWND hWnd, UINT msg, WPARAM wParam, LPAR
         return 0;
 
     case WM_DESTROY:
-        KillTimer(hWnd, TIMER_ID);
+        // Both threads use the GDI objects below
+        StopThreads();
         if (g_font)      { DeleteObject(g_font); g_font = nullptr; }
         if (g_fontSmall)  { DeleteObject(g_fontSmall); g_fontSmall = nullptr; }
         if (g_memDC) {
@@ -1087,12 +998,28 @@ static LRESULT CALLBACK ScreenSaverProc(HWND hWnd, UINT msg, WPARAM wParam, LPAR
             DeleteDC(g_blackDC);
             g_blackDC = nullptr;
         }
-        // Clean up tail bitmaps
-        for (auto& s : g_streams) {
-            CleanupTailBitmap(s);
+        if (g_blockDC) {
+            SelectObject(g_blockDC, g_blockOldBmp);
+            DeleteObject(g_blockBmp);
+            DeleteDC(g_blockDC);
+            g_blockDC = nullptr;
+        }
+        if (g_landedDC) {
+            SelectObject(g_landedDC, g_landedOldBmp);
+            DeleteObject(g_landedBmp);
+            DeleteDC(g_landedDC);
+            g_landedDC = nullptr;
         }
-        if (g_highlightPen) { DeleteObject(g_highlightPen); g_highlightPen = nullptr; }
-        if (g_scanlinePen)  { DeleteObject(g_scanlinePen); g_scanlinePen = nullptr; }
+        // Clean up tail slabs
+        CleanupTailSlabs();
+        if (g_scanlineBrush) { DeleteObject(g_scanlineBrush); g_scanlineBrush = nullptr; }
+        if (g_scanlineDC) {
+            SelectObject(g_scanlineDC, g_scanlineOldBmp);
+            DeleteDC(g_scanlineDC);
+            g_scanlineDC = nullptr;
+        }
+        if (g_scanlineBmp) { DeleteObject(g_scanlineBmp); g_scanlineBmp = nullptr; }
+        g_gdiObjects.Clear();
         ShowCursor(TRUE);
         PostQuitMessage(0);
         return 0;
@@ -1122,6 +1049,15 @@ static INT_PTR CALLBACK ConfigDlgProc(HWND hDlg, UINT msg, WPARAM wParam, LPARAM
 //   /m [N]       → same as /s /m [N]
 //   /c           → show configuration dialog
 //   /p <hwnd>    → preview in the little monitor in Display Properties
+//   /seed N      → seed the simulation with N (default: current time)
+//   /simhz N     → run N simulation ticks per second (default: ~22)
+//   /fps N       → draw N frames per second (default: follow vsync)
+//   /scanlines N → darken every Nth pixel row, 0 = none (default: 3)
+//   /scanlinedim P → darken scanlines by P percent (default: 100, black)
+//   /stats       → overlay rolling per-phase timings on the first monitor
+//   /profile F   → write the same timings to CSV file F once a second
+//   /budget MS   → lower quality while a frame takes more than MS of CPU time,
+//                  0 = never (default: 0)
 
 int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, LPWSTR lpCmdLine, int) {
     // Declare per-monitor DPI awareness so we get real physical pixel coordinates
@@ -1153,6 +1089,39 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, LPWSTR lpCmdLine, int) {
                 g_targetMonitor = 0; // /m with no number = primary
             }
             doRun = true;
+        } else if (_wcsicmp(arg, L"sw") == 0) {
+            // /sw — draw with the software framebuffer renderer
+            g_softwareRender = true;
+        } else if (_wcsicmp(arg, L"seed") == 0 && i + 1 < argc) {
+            // /seed N — deterministic run, e.g. for comparing performance
+            g_seed = (uint32_t)wcstoul(argv[++i], nullptr, 10);
+            g_fixedSeed = true;
+        } else if (_wcsicmp(arg, L"simhz") == 0 && i + 1 < argc) {
+            // /simhz N — simulation rate; movement still happens per tick
+            int hz = _wtoi(argv[++i]);
+            if (hz > 0) g_tickMs = 1000.0 / hz;
+        } else if (_wcsicmp(arg, L"fps") == 0 && i + 1 < argc) {
+            // /fps N — fixed frame rate instead of vsync
+            int fps = _wtoi(argv[++i]);
+            if (fps > 0) g_targetFps = fps;
+        } else if (_wcsicmp(arg, L"scanlines") == 0 && i + 1 < argc) {
+            // /scanlines N — scanline pitch
+            int pitch = _wtoi(argv[++i]);
+            if (pitch >= 0) g_scanlines.pitch = pitch;
+        } else if (_wcsicmp(arg, L"scanlinedim") == 0 && i + 1 < argc) {
+            // /scanlinedim P — scanline darkness
+            int pct = _wtoi(argv[++i]);
+            if (pct >= 0 && pct <= 100) g_scanlines.intensity = pct * 255 / 100;
+        } else if (_wcsicmp(arg, L"stats") == 0) {
+            // /stats — profiler overlay
+            g_showStats = true;
+        } else if (_wcsicmp(arg, L"budget") == 0 && i + 1 < argc) {
+            // /budget MS — quality governor's frame budget
+            double ms = _wtof(argv[++i]);
+            if (ms >= 0.0) g_frameBudgetMs = ms;
+        } else if (_wcsicmp(arg, L"profile") == 0 && i + 1 < argc) {
+            // /profile FILE — profiler percentiles as CSV
+            wcsncpy(g_profilePath, argv[++i], MAX_PATH - 1);
         } else if (_wcsicmp(arg, L"c") == 0) {
             doConfig = true;
         } else if (_wcsicmp(arg, L"p") == 0) {
@@ -1177,6 +1146,9 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, LPWSTR lpCmdLine, int) {
 
     LocalFree(argv);
 
+    // Timers stay disabled (one branch each) unless something reads them
+    g_profiler.enabled = g_showStats || g_profilePath[0];
+
     if (doConfig) {
         DialogBox(hInstance, MAKEINTRESOURCE(IDD_CONFIG), nullptr, ConfigDlgProc);
         return 0;
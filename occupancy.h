@@ -0,0 +1,109 @@
+// Matrix Tetris occupancy bitboard
+// One bit per landed cell, 64 columns per word, mirroring LandedCell::Filled().
+// Collision tests and row-content scans work on whole words instead of
+// probing the (much larger) LandedCell grid one cell at a time.
+// Each monitor has its own grid, written only by the thread simulating its
+// group, so words are plain loads and stores.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static inline int PopCount64(uint64_t v) {
+#if defined(_MSC_VER)
+    return (int)__popcnt64(v);
+#else
+    return __builtin_popcountll(v);
+#endif
+}
+
+static inline int CountTrailingZeros64(uint64_t v) {  // v != 0
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward64(&idx, v);
+    return (int)idx;
+#else
+    return __builtin_ctzll(v);
+#endif
+}
+
+struct OccupancyGrid {
+    int cols = 0;
+    int rows = 0;
+    int wordsPerRow = 0;
+    std::vector<uint64_t> words;   // [row * wordsPerRow + col / 64], bit = col % 64
+
+    void Reset(int numCols, int numRows) {
+        cols = numCols;
+        rows = numRows;
+        wordsPerRow = (numCols + 63) / 64;
+        words.assign((size_t)wordsPerRow * numRows, 0);
+    }
+
+    uint64_t* Row(int r)             { return &words[(size_t)r * wordsPerRow]; }
+    const uint64_t* Row(int r) const { return &words[(size_t)r * wordsPerRow]; }
+
+    void Set(int r, int c)        { Row(r)[c >> 6] |= 1ull << (c & 63); }
+    void Clear(int r, int c)      { Row(r)[c >> 6] &= ~(1ull << (c & 63)); }
+    bool Test(int r, int c) const { return (Row(r)[c >> 6] >> (c & 63)) & 1; }
+
+    // Bits of word w that fall inside columns [left, right)
+    static uint64_t SpanMask(int w, int left, int right) {
+        int lo = left - w * 64;
+        int hi = right - w * 64;
+        if (lo < 0)  lo = 0;
+        if (hi > 64) hi = 64;
+        if (hi <= lo) return 0;
+        uint64_t m = (hi - lo == 64) ? ~0ull : ((1ull << (hi - lo)) - 1);
+        return m << lo;
+    }
+
+    // 4 occupancy bits of row r starting at column col (bit 0 = col).
+    // Columns outside the grid read as empty, so col may be slightly negative.
+    uint32_t Bits4(int r, int col) const {
+        if (col < 0) {
+            if (col <= -4) return 0;
+            return (Bits4(r, 0) << -col) & 0xF;
+        }
+        int w = col >> 6;
+        if (w >= wordsPerRow) return 0;
+        int sh = col & 63;
+        const uint64_t* row = Row(r);
+        uint64_t v = row[w] >> sh;
+        if (sh > 60 && w + 1 < wordsPerRow) v |= row[w + 1] << (64 - sh);
+        return (uint32_t)(v & 0xF);
+    }
+
+    // Number of filled cells of row r in columns [left, right)
+    int RowCount(int r, int left, int right) const {
+        const uint64_t* row = Row(r);
+        int n = 0;
+        for (int w = left >> 6; w <= (right - 1) >> 6; w++) {
+            n += PopCount64(row[w] & SpanMask(w, left, right));
+        }
+        return n;
+    }
+
+    // Copy columns [left, right) of srcRow over the same columns of dstRow
+    void CopyRowSpan(int dstRow, int srcRow, int left, int right) {
+        uint64_t* dst = Row(dstRow);
+        const uint64_t* src = Row(srcRow);
+        for (int w = left >> 6; w <= (right - 1) >> 6; w++) {
+            uint64_t m = SpanMask(w, left, right);
+            dst[w] = (dst[w] & ~m) | (src[w] & m);
+        }
+    }
+
+    // Empty columns [left, right) of row r
+    void ClearRowSpan(int r, int left, int right) {
+        uint64_t* row = Row(r);
+        for (int w = left >> 6; w <= (right - 1) >> 6; w++) {
+            row[w] &= ~SpanMask(w, left, right);
+        }
+    }
+};
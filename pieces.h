@@ -0,0 +1,132 @@
+// Matrix Tetris piece tables
+// Every rotation of every tetromino is one 16-bit mask; everything the
+// simulation and renderer need per rotation (row masks, bounding box, cell
+// offsets) is derived from those masks at compile time.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// ─── Tetris Piece Definitions ────────────────────────────────────────────────
+// Each piece is 4 rotations of a 4×4 box; bit (row * 4 + col) set = filled
+
+constexpr uint16_t PieceRows(const char* r0, const char* r1, const char* r2, const char* r3) {
+    const char* rows[4] = {r0, r1, r2, r3};
+    uint16_t mask = 0;
+    for (int r = 0; r < 4; r++)
+        for (int c = 0; c < 4; c++)
+            if (rows[r][c] == '#') mask |= (uint16_t)(1u << (r * 4 + c));
+    return mask;
+}
+
+// [piece][rotation] — 56 bytes, a single cache line
+alignas(64) static constexpr uint16_t PIECE_MASKS[7][4] = {
+    { // I
+        PieceRows("....", "####", "....", "...."),
+        PieceRows("..#.", "..#.", "..#.", "..#."),
+        PieceRows("....", "....", "####", "...."),
+        PieceRows(".#..", ".#..", ".#..", ".#.."),
+    },
+    { // O
+        PieceRows(".##.", ".##.", "....", "...."),
+        PieceRows(".##.", ".##.", "....", "...."),
+        PieceRows(".##.", ".##.", "....", "...."),
+        PieceRows(".##.", ".##.", "....", "...."),
+    },
+    { // T
+        PieceRows(".#..", "###.", "....", "...."),
+        PieceRows(".#..", ".##.", ".#..", "...."),
+        PieceRows("....", "###.", ".#..", "...."),
+        PieceRows(".#..", "##..", ".#..", "...."),
+    },
+    { // S
+        PieceRows(".##.", "##..", "....", "...."),
+        PieceRows(".#..", ".##.", "..#.", "...."),
+        PieceRows("....", ".##.", "##..", "...."),
+        PieceRows("#...", "##..", ".#..", "...."),
+    },
+    { // Z
+        PieceRows("##..", ".##.", "....", "...."),
+        PieceRows("..#.", ".##.", ".#..", "...."),
+        PieceRows("....", "##..", ".##.", "...."),
+        PieceRows(".#..", "##..", "#...", "...."),
+    },
+    { // J
+        PieceRows("#...", "###.", "....", "...."),
+        PieceRows(".##.", ".#..", ".#..", "...."),
+        PieceRows("....", "###.", "..#.", "...."),
+        PieceRows(".#..", ".#..", "##..", "...."),
+    },
+    { // L
+        PieceRows("..#.", "###.", "....", "...."),
+        PieceRows(".#..", ".#..", ".##.", "...."),
+        PieceRows("....", "###.", "#...", "...."),
+        PieceRows("##..", ".#..", ".#..", "...."),
+    },
+};
+
+// ─── Derived per-rotation data ───────────────────────────────────────────────
+
+struct PieceShape {
+    uint8_t rowBits[4];   // 4-bit mask per row (bit c = column c)
+    int8_t  topRow;       // first row with a filled cell
+    int8_t  bottomRow;    // last row with a filled cell
+    int8_t  leftCol;      // bounding box columns
+    int8_t  rightCol;
+    int8_t  cellRow[4];   // filled cell offsets within the 4×4 box, row-major
+    int8_t  cellCol[4];
+    int8_t  colBottom[4]; // lowest filled row per column, -1 if the column is empty
+};
+
+constexpr PieceShape MakePieceShape(uint16_t mask) {
+    PieceShape sh = {{0, 0, 0, 0}, 4, -1, 4, -1, {0, 0, 0, 0}, {0, 0, 0, 0}, {-1, -1, -1, -1}};
+    int n = 0;
+    for (int r = 0; r < 4; r++) {
+        for (int c = 0; c < 4; c++) {
+            if (!(mask & (1u << (r * 4 + c)))) continue;
+            sh.rowBits[r] |= (uint8_t)(1u << c);
+            if (r < sh.topRow)    sh.topRow    = (int8_t)r;
+            if (r > sh.bottomRow) sh.bottomRow = (int8_t)r;
+            if (c < sh.leftCol)   sh.leftCol   = (int8_t)c;
+            if (c > sh.rightCol)  sh.rightCol  = (int8_t)c;
+            if (r > sh.colBottom[c]) sh.colBottom[c] = (int8_t)r;
+            if (n < 4) {
+                sh.cellRow[n] = (int8_t)r;
+                sh.cellCol[n] = (int8_t)c;
+            }
+            n++;
+        }
+    }
+    return sh;
+}
+
+constexpr std::array<std::array<PieceShape, 4>, 7> MakePieceShapes() {
+    std::array<std::array<PieceShape, 4>, 7> shapes = {};
+    for (int p = 0; p < 7; p++)
+        for (int rot = 0; rot < 4; rot++)
+            shapes[p][rot] = MakePieceShape(PIECE_MASKS[p][rot]);
+    return shapes;
+}
+
+// [piece][rotation]
+static constexpr std::array<std::array<PieceShape, 4>, 7> PIECE_SHAPES = MakePieceShapes();
+
+// Every tetromino rotation has exactly 4 cells spanning contiguous rows
+constexpr bool PieceShapesValid() {
+    for (int p = 0; p < 7; p++) {
+        for (int rot = 0; rot < 4; rot++) {
+            const PieceShape& sh = PIECE_SHAPES[p][rot];
+            int cells = 0;
+            for (int r = 0; r < 4; r++) {
+                int bits = sh.rowBits[r];
+                while (bits) { cells += bits & 1; bits >>= 1; }
+                bool inside = (r >= sh.topRow && r <= sh.bottomRow);
+                if (inside != (sh.rowBits[r] != 0)) return false;
+            }
+            if (cells != 4) return false;
+        }
+    }
+    return true;
+}
+static_assert(PieceShapesValid(), "every piece rotation must be 4 cells in contiguous rows");
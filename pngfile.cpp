@@ -0,0 +1,168 @@
+// Matrix Tetris PNG output — see pngfile.h
+
+#include "pngfile.h"
+
+#include <cstdio>
+#include <cstring>
+
+// ─── Checksums ───────────────────────────────────────────────────────────────
+
+static uint32_t Crc32(uint32_t crc, const uint8_t* data, size_t n) {
+    static uint32_t table[256];
+    static bool init = false;
+    if (!init) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        init = true;
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < n; i++) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static uint32_t Adler32(uint32_t adler, const uint8_t* data, size_t n) {
+    uint32_t a = adler & 0xFFFF, b = adler >> 16;
+    for (size_t i = 0; i < n; i++) {
+        a = (a + data[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+}
+
+// ─── Writing ─────────────────────────────────────────────────────────────────
+
+static void PutU32(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back((uint8_t)(v >> 24));
+    out.push_back((uint8_t)(v >> 16));
+    out.push_back((uint8_t)(v >> 8));
+    out.push_back((uint8_t)v);
+}
+
+static bool WriteChunk(FILE* f, const char* type, const std::vector<uint8_t>& data) {
+    std::vector<uint8_t> hdr;
+    PutU32(hdr, (uint32_t)data.size());
+    uint8_t tag[4];
+    memcpy(tag, type, 4);
+    uint32_t crc = Crc32(0, tag, 4);
+    if (!data.empty()) crc = Crc32(crc, data.data(), data.size());
+    std::vector<uint8_t> tail;
+    PutU32(tail, crc);
+    return fwrite(hdr.data(), 1, 4, f) == 4 && fwrite(tag, 1, 4, f) == 4 &&
+           (data.empty() || fwrite(data.data(), 1, data.size(), f) == data.size()) &&
+           fwrite(tail.data(), 1, 4, f) == 4;
+}
+
+bool WritePng(const char* path, const Framebuffer& fb) {
+    // Raw scanlines: filter byte 0 then R, G, B per pixel
+    size_t rowBytes = 1 + (size_t)fb.width * 3;
+    std::vector<uint8_t> raw(rowBytes * fb.height);
+    for (int y = 0; y < fb.height; y++) {
+        uint8_t* dst = &raw[rowBytes * y];
+        const Pixel* src = fb.Row(y);
+        *dst++ = 0;
+        for (int x = 0; x < fb.width; x++) {
+            *dst++ = (uint8_t)(src[x] >> 16);
+            *dst++ = (uint8_t)(src[x] >> 8);
+            *dst++ = (uint8_t)src[x];
+        }
+    }
+
+    // zlib stream of stored deflate blocks
+    std::vector<uint8_t> z = {0x78, 0x01};
+    size_t pos = 0;
+    do {
+        size_t len = raw.size() - pos;
+        if (len > 65535) len = 65535;
+        bool last = (pos + len == raw.size());
+        z.push_back(last ? 1 : 0);
+        z.push_back((uint8_t)len);
+        z.push_back((uint8_t)(len >> 8));
+        z.push_back((uint8_t)~len);
+        z.push_back((uint8_t)(~len >> 8));
+        z.insert(z.end(), raw.begin() + pos, raw.begin() + pos + len);
+        pos += len;
+    } while (pos < raw.size());
+    PutU32(z, Adler32(1, raw.data(), raw.size()));
+
+    std::vector<uint8_t> ihdr;
+    PutU32(ihdr, (uint32_t)fb.width);
+    PutU32(ihdr, (uint32_t)fb.height);
+    ihdr.insert(ihdr.end(), {8, 2, 0, 0, 0});  // 8-bit RGB, deflate, no filter, no interlace
+
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    static const uint8_t sig[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    bool ok = fwrite(sig, 1, 8, f) == 8 && WriteChunk(f, "IHDR", ihdr) &&
+              WriteChunk(f, "IDAT", z) && WriteChunk(f, "IEND", {});
+    return (fclose(f) == 0) && ok;
+}
+
+// ─── Reading ─────────────────────────────────────────────────────────────────
+
+static uint32_t GetU32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+bool ReadPng(const char* path, std::vector<Pixel>& pixels, int& width, int& height) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    std::vector<uint8_t> file;
+    uint8_t buf[65536];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) file.insert(file.end(), buf, buf + n);
+    fclose(f);
+
+    static const uint8_t sig[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    if (file.size() < 8 || memcmp(file.data(), sig, 8) != 0) return false;
+
+    // Collect IHDR and the concatenated IDAT payload
+    std::vector<uint8_t> z;
+    width = height = 0;
+    size_t pos = 8;
+    while (pos + 12 <= file.size()) {
+        uint32_t len = GetU32(&file[pos]);
+        const uint8_t* type = &file[pos + 4];
+        const uint8_t* data = &file[pos + 8];
+        if (pos + 12 + len > file.size()) return false;
+        if (memcmp(type, "IHDR", 4) == 0) {
+            if (len != 13 || data[8] != 8 || data[9] != 2 || data[12] != 0) return false;
+            width  = (int)GetU32(data);
+            height = (int)GetU32(data + 4);
+        } else if (memcmp(type, "IDAT", 4) == 0) {
+            z.insert(z.end(), data, data + len);
+        } else if (memcmp(type, "IEND", 4) == 0) {
+            break;
+        }
+        pos += 12 + len;
+    }
+    if (width <= 0 || height <= 0 || z.size() < 2) return false;
+
+    // Only stored deflate blocks are understood
+    std::vector<uint8_t> raw;
+    size_t zp = 2;
+    bool last = false;
+    while (!last) {
+        if (zp + 5 > z.size() || (z[zp] & 0x06) != 0) return false;
+        last = (z[zp] & 1) != 0;
+        size_t len = z[zp + 1] | ((size_t)z[zp + 2] << 8);
+        zp += 5;
+        if (zp + len > z.size()) return false;
+        raw.insert(raw.end(), z.begin() + zp, z.begin() + zp + len);
+        zp += len;
+    }
+
+    size_t rowBytes = 1 + (size_t)width * 3;
+    if (raw.size() != rowBytes * height) return false;
+    pixels.resize((size_t)width * height);
+    for (int y = 0; y < height; y++) {
+        const uint8_t* src = &raw[rowBytes * y];
+        if (*src++ != 0) return false;  // only filter type 0 (none)
+        for (int x = 0; x < width; x++, src += 3) {
+            pixels[(size_t)y * width + x] = 0xFF000000u | ((Pixel)src[0] << 16) | ((Pixel)src[1] << 8) | src[2];
+        }
+    }
+    return true;
+}
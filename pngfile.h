@@ -0,0 +1,18 @@
+// Matrix Tetris PNG output
+// Minimal dependency-free PNG writer (and a reader for the files it writes)
+// so headless runs can save software-rendered frames and compare them
+// against golden images. Images are 8-bit RGB with uncompressed (stored)
+// deflate blocks: large, but exact and trivial to read back.
+
+#pragma once
+
+#include <vector>
+
+#include "softrender.h"
+
+// Write the framebuffer as an RGB PNG. Returns false on I/O failure.
+bool WritePng(const char* path, const Framebuffer& fb);
+
+// Read a PNG produced by WritePng into opaque BGRA pixels. Returns false if
+// the file is missing or not in that exact format.
+bool ReadPng(const char* path, std::vector<Pixel>& pixels, int& width, int& height);
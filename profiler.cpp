@@ -0,0 +1,62 @@
+// Matrix Tetris frame profiler — see profiler.h
+
+#include "profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+Profiler g_profiler;
+
+int64_t Profiler::Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char* Profiler::PhaseName(ProfilePhase phase) {
+    static const char* const NAMES[PROF_NUM_PHASES] = {
+        "rowclears", "streams", "collision", "fade", "snapshot",
+        "damage", "clear", "landed", "flash", "tails", "pieces", "record", "scanlines", "present",
+    };
+    return NAMES[phase];
+}
+
+void Profiler::EndSample(int firstPhase, int endPhase) {
+    if (!enabled) return;
+    for (int p = firstPhase; p < endPhase; p++) {
+        int64_t ns = current[p].exchange(0, std::memory_order_relaxed);
+        History& h = history[p];
+        uint32_t n = h.count.load(std::memory_order_relaxed);
+        h.us[n % PROFILE_HISTORY].store((uint32_t)std::min<int64_t>(ns / 1000, UINT32_MAX),
+                                        std::memory_order_relaxed);
+        h.count.store(n + 1, std::memory_order_release);
+    }
+}
+
+ProfileStats Profiler::Stats(ProfilePhase phase) const {
+    const History& h = history[phase];
+    int n = (int)std::min<uint32_t>(h.count.load(std::memory_order_acquire), PROFILE_HISTORY);
+    ProfileStats s = {n, 0.0f, 0.0f, 0.0f, 0.0f};
+    if (!n) return s;
+    std::vector<uint32_t> us(n);
+    for (int i = 0; i < n; i++) us[i] = h.us[i].load(std::memory_order_relaxed);
+    std::sort(us.begin(), us.end());
+    auto pct = [&](int p) { return (float)us[std::min(n - 1, n * p / 100)]; };
+    s.p50 = pct(50);
+    s.p95 = pct(95);
+    s.p99 = pct(99);
+    s.max = (float)us[n - 1];
+    return s;
+}
+
+void Profiler::WriteCsvHeader(FILE* f) {
+    fprintf(f, "seconds,phase,samples,p50_us,p95_us,p99_us,max_us\n");
+}
+
+void Profiler::WriteCsvRows(FILE* f, double seconds) const {
+    for (int p = 0; p < PROF_NUM_PHASES; p++) {
+        ProfileStats s = Stats((ProfilePhase)p);
+        fprintf(f, "%.3f,%s,%d,%.0f,%.0f,%.0f,%.0f\n", seconds, PhaseName((ProfilePhase)p),
+                s.samples, s.p50, s.p95, s.p99, s.max);
+    }
+}
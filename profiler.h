@@ -0,0 +1,103 @@
+// Matrix Tetris frame profiler
+// Scoped timers around the simulation and render phases. Each phase adds up
+// its time over one tick (simulation phases) or one frame (render phases);
+// the last PROFILE_HISTORY sums are kept so rolling percentiles can be shown
+// in the overlay or written to CSV. Disabled, a timer costs one branch.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+
+enum ProfilePhase {
+    // Per tick, on the simulation thread (and its workers)
+    PROF_ROW_CLEARS,   // row-clear state machine
+    PROF_STREAMS,      // stream movement, including collision and landing
+    PROF_COLLISION,    // piece fit tests only (CPU time summed over workers)
+    PROF_FADE,         // glow fade of landed cells
+    PROF_SNAPSHOT,     // copying the state out for the renderer
+
+    // Per frame, on the render thread
+    PROF_DAMAGE,       // damage tracking and redraw rectangles
+    PROF_CLEAR,        // clearing the damaged background
+    PROF_LANDED,       // landed blocks, drop animation
+    PROF_FLASH,        // flashing cleared rows
+    PROF_TAILS,        // character tails
+    PROF_PIECES,       // falling pieces
+    PROF_RECORD,       // GDI: recording and grouping the frame's draw list
+    PROF_SCANLINES,    // CRT scanline overlay
+    PROF_PRESENT,      // copying the frame to the screen
+
+    PROF_NUM_PHASES
+};
+static const int PROF_FIRST_FRAME_PHASE = PROF_DAMAGE;
+
+static const int PROFILE_HISTORY = 512;  // ticks or frames per rolling window
+
+// Rolling statistics of one phase, in microseconds
+struct ProfileStats {
+    int   samples;
+    float p50, p95, p99, max;
+};
+
+class Profiler {
+public:
+    // Set once before any timed thread starts
+    bool enabled = false;
+
+    static int64_t Now();  // nanoseconds, monotonic
+    static const char* PhaseName(ProfilePhase phase);
+
+    // Add time to the phase's current tick or frame (any thread)
+    void Add(ProfilePhase phase, int64_t ns) {
+        current[phase].fetch_add(ns, std::memory_order_relaxed);
+    }
+    // Close the current sample of every per-tick / per-frame phase
+    void EndTick()  { EndSample(0, PROF_FIRST_FRAME_PHASE); }
+    void EndFrame() { EndSample(PROF_FIRST_FRAME_PHASE, PROF_NUM_PHASES); }
+
+    ProfileStats Stats(ProfilePhase phase) const;
+
+    // CSV of rolling percentiles, one row per phase per call
+    static void WriteCsvHeader(FILE* f);
+    void WriteCsvRows(FILE* f, double seconds) const;
+
+private:
+    struct History {
+        std::atomic<uint32_t> us[PROFILE_HISTORY];
+        std::atomic<uint32_t> count{0};  // samples ever written
+    };
+    std::atomic<int64_t> current[PROF_NUM_PHASES] = {};
+    History              history[PROF_NUM_PHASES];
+
+    void EndSample(int firstPhase, int endPhase);
+};
+
+extern Profiler g_profiler;
+
+// Times the enclosing scope into a phase when profiling is enabled
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfilePhase p) : phase(p), timing(g_profiler.enabled) {
+        if (timing) start = Profiler::Now();
+    }
+    ~ProfileScope() {
+        if (timing) g_profiler.Add(phase, Profiler::Now() - start);
+    }
+
+    // Close the current phase and time what follows into another
+    void Switch(ProfilePhase next) {
+        if (timing) {
+            int64_t now = Profiler::Now();
+            g_profiler.Add(phase, now - start);
+            start = now;
+        }
+        phase = next;
+    }
+
+private:
+    ProfilePhase phase;
+    bool         timing;
+    int64_t      start = 0;
+};
@@ -0,0 +1,49 @@
+// Matrix Tetris renderer interface
+// A renderer draws a simulation snapshot (snapshot.h) into its own surface.
+// The screensaver picks the GDI backend (main.cpp) or the software framebuffer
+// backend (softrender.h) at startup; headless tools drive the software backend
+// directly.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "damage.h"
+
+// CRT scanlines, applied over everything else that was drawn: every pitch-th
+// screen row, starting at the top, is darkened by intensity / 255
+struct ScanlineSettings {
+    int pitch     = 3;    // 0 = no scanlines
+    int intensity = 255;  // 255 = black rows, 0 = no scanlines
+
+    bool Enabled() const { return pitch > 0 && intensity > 0; }
+    bool operator==(const ScanlineSettings& o) const { return pitch == o.pitch && intensity == o.intensity; }
+    bool operator!=(const ScanlineSettings& o) const { return !(*this == o); }
+
+    // Darkening of each of height rows, 0 where a row is left alone
+    void BuildMask(std::vector<uint8_t>& mask, int height) const {
+        mask.assign(height, 0);
+        if (!Enabled()) return;
+        uint8_t amount = (uint8_t)(intensity < 255 ? intensity : 255);
+        for (int y = 0; y < height; y += pitch) mask[y] = amount;
+    }
+};
+
+class Renderer {
+public:
+    virtual ~Renderer() {}
+
+    // Drawing settings. Undamaged parts of the screen keep what they were
+    // drawn with, so a change is followed by a full redraw.
+    ScanlineSettings scanlines;
+    bool bevels = true;  // beveled block edges, flat blocks if off (sprite-based backends may ignore it)
+
+    // Bring any cached state up to date with a newly taken snapshot (its
+    // change lists, respawned streams and swapped glyphs). Called once per
+    // snapshot, before it is drawn.
+    virtual void AfterTick(const SimSnapshot&) {}
+
+    // Redraw the given disjoint screen rectangles from the snapshot
+    virtual void RenderFrame(const SimSnapshot& snap, const std::vector<PixelRect>& rects) = 0;
+};
@@ -0,0 +1,69 @@
+// Matrix Tetris random numbers
+// xoshiro128** — 128 bits of state, a handful of ALU ops per 32-bit output and
+// far better statistics than the C runtime's rand(). Each generator is an
+// independent value, so every monitor can own one: runs replay exactly from a
+// seed, and monitors can be stepped on different threads without sharing state.
+
+#pragma once
+
+#include <cstdint>
+
+struct Rng {
+    uint32_t s[4];
+
+    // Derive the state from a seed and a stream id with splitmix64, so
+    // neighbouring seeds and ids still give unrelated sequences
+    void Seed(uint64_t seed, uint64_t streamId) {
+        uint64_t x = seed ^ (streamId * 0xD1B54A32D192ED03ull);
+        for (int i = 0; i < 4; i += 2) {
+            x += 0x9E3779B97F4A7C15ull;
+            uint64_t z = x;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            z ^= z >> 31;
+            s[i]     = (uint32_t)z;
+            s[i + 1] = (uint32_t)(z >> 32);
+        }
+        if (!(s[0] | s[1] | s[2] | s[3])) s[0] = 1;  // all-zero state is a fixed point
+    }
+
+    uint32_t Next() {
+        uint32_t result = Rotl(s[1] * 5, 7) * 9;
+        uint32_t t = s[1] << 9;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = Rotl(s[3], 11);
+        return result;
+    }
+
+    // Fill out[0..n) in one tight loop, keeping the state in registers
+    void Fill(uint32_t* out, int n) {
+        uint32_t s0 = s[0], s1 = s[1], s2 = s[2], s3 = s[3];
+        for (int i = 0; i < n; i++) {
+            out[i] = Rotl(s1 * 5, 7) * 9;
+            uint32_t t = s1 << 9;
+            s2 ^= s0;
+            s3 ^= s1;
+            s1 ^= s2;
+            s0 ^= s3;
+            s2 ^= t;
+            s3 = Rotl(s3, 11);
+        }
+        s[0] = s0; s[1] = s1; s[2] = s2; s[3] = s3;
+    }
+
+    // Uniform in [0, n): multiply-shift instead of modulo
+    uint32_t Below(uint32_t n) { return (uint32_t)(((uint64_t)Next() * n) >> 32); }
+
+    // Uniform in [lo, hi]
+    int Int(int lo, int hi) { return lo + (int)Below((uint32_t)(hi - lo + 1)); }
+
+    // Uniform in [lo, hi), from the top 24 bits
+    float Float(float lo, float hi) { return lo + (float)(Next() >> 8) * (1.0f / 16777216.0f) * (hi - lo); }
+
+private:
+    static uint32_t Rotl(uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+};
@@ -0,0 +1,823 @@
+// Matrix Tetris simulation core — see sim.h
+
+#include "sim.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <thread>
+
+#include "profiler.h"
+#include "workers.h"
+
+// ─── Simulation state ────────────────────────────────────────────────────────
+
+int                                  g_gridCols = 0;
+int                                  g_gridRows = 0;
+std::vector<MonitorGrid>             g_monitors;
+StreamSet                            g_streams;
+std::vector<int>                     g_monitorFirstStream; // [monitor] -> first stream, plus end
+std::vector<Rng>                     g_monitorRng;    // one generator per monitor
+TailGradients                        g_tailGradients;
+std::vector<LandedGrid>              g_landed;    // one per monitor
+std::vector<OccupancyGrid>           g_occupancy; // per monitor: filled bits, kept in sync with g_landed
+std::vector<MonitorClearInfo>        g_monitorClears; // one per monitor
+std::vector<MonitorFill>             g_monitorFill;   // one per monitor
+std::vector<MonitorGroup>            g_monitorGroups; // monitors simulated together
+std::vector<CellPos>                 g_changedCells;  // cells that landed or faded this tick
+std::vector<RowBand>                 g_changedBands;  // row bands cleared or shifted this tick
+
+static std::vector<uint32_t>         g_streamRolls;   // one random word per stream, drawn each tick
+static std::vector<int>              g_groupOf;       // [monitor] -> index into g_monitorGroups
+static WorkerPool                    g_workers;
+static int                           g_threadsWanted = 1;
+static std::vector<int>              g_monitorFirstTail; // [monitor] -> first tail-only stream
+static float                         g_tailStreamShare = 1.0f; // SetStreamQuality
+static int                           g_maxTailLength = 0;
+
+// A stream mutates one tail character on 1 in 5 ticks
+static const uint32_t MUTATE_ROLL_LIMIT = 0xFFFFFFFFu / 5;
+
+// ─── Helpers ─────────────────────────────────────────────────────────────────
+
+static wchar_t RandMatrixChar(Rng& rng) {
+    // Half-width katakana + digits + latin — the glyph set in glyphs.h
+    uint32_t r = rng.Below(3);
+    if (r == 0) return (wchar_t)(GLYPH_KATAKANA_FIRST + rng.Below(GLYPH_NUM_KATAKANA));  // katakana
+    if (r == 1) return (wchar_t)('0' + rng.Below(GLYPH_NUM_DIGITS));                     // digits
+    return (wchar_t)('A' + rng.Below(GLYPH_NUM_LATIN));                                   // latin
+}
+
+// Slow streams get long tails, fast streams get short tails (Matrix look)
+static int MaxTailLength(float speed, int monH) {
+    int maxLen = (speed < 0.3f) ? monH / 2 : (speed < 0.6f) ? monH / 3 : monH / 5;
+    maxLen = maxLen * 5 / 4; // 25% longer tails
+    if (maxLen < 8) maxLen = 8;
+    return maxLen;
+}
+
+// ─── Monitor groups ──────────────────────────────────────────────────────────
+
+static bool MonitorsOverlap(const MonitorGrid& a, const MonitorGrid& b) {
+    return a.left < b.right && b.left < a.right && a.top < b.bottom && b.top < a.bottom;
+}
+
+// Group monitors connected by overlapping grid rectangles (rounding to whole
+// cells can make stacked monitors share a row)
+static void BuildMonitorGroups() {
+    int n = (int)g_monitors.size();
+    std::vector<int> parent(n);
+    for (int i = 0; i < n; i++) parent[i] = i;
+    auto find = [&](int i) {
+        while (parent[i] != i) i = parent[i] = parent[parent[i]];
+        return i;
+    };
+    for (int i = 0; i < n; i++) {
+        for (int j = i + 1; j < n; j++) {
+            if (MonitorsOverlap(g_monitors[i], g_monitors[j])) parent[find(j)] = find(i);
+        }
+    }
+    g_monitorGroups.clear();
+    g_groupOf.assign(n, -1);
+    for (int i = 0; i < n; i++) {
+        int root = find(i);
+        if (g_groupOf[root] < 0) {
+            g_groupOf[root] = (int)g_monitorGroups.size();
+            g_monitorGroups.emplace_back();
+        }
+        g_groupOf[i] = g_groupOf[root];
+        g_monitorGroups[g_groupOf[i]].monitors.push_back(i);
+    }
+}
+
+// Size the pool for the current layout: more threads than groups never helps
+static void StartWorkers() {
+    int threads = g_threadsWanted > 0 ? g_threadsWanted : (int)std::thread::hardware_concurrency();
+    int groups = (int)g_monitorGroups.size();
+    if (groups > 0 && threads > groups) threads = groups;
+    if (threads < 1) threads = 1;
+    if (threads != g_workers.Threads()) g_workers.Start(threads);
+}
+
+void SetSimulationThreads(int numThreads) {
+    g_threadsWanted = numThreads;
+    StartWorkers();
+}
+
+int GetSimulationThreads() {
+    return g_workers.Threads();
+}
+
+// Move the changes each group recorded into the shared per-tick lists
+static void CollectGroupChanges() {
+    for (auto& grp : g_monitorGroups) {
+        g_changedCells.insert(g_changedCells.end(), grp.changedCells.begin(), grp.changedCells.end());
+        g_changedBands.insert(g_changedBands.end(), grp.changedBands.begin(), grp.changedBands.end());
+        grp.changedCells.clear();
+        grp.changedBands.clear();
+    }
+}
+
+// ─── Initialization ──────────────────────────────────────────────────────────
+
+void InitSimulation(int gridCols, int gridRows, const std::vector<MonitorGrid>& monitors, uint32_t seed) {
+    g_gridCols = gridCols;
+    g_gridRows = gridRows;
+    g_monitors = monitors;
+
+    // init landed grids, one per monitor in its own coordinates
+    g_landed.resize(g_monitors.size());
+    g_occupancy.resize(g_monitors.size());
+    for (int mi = 0; mi < (int)g_monitors.size(); mi++) {
+        const auto& m = g_monitors[mi];
+        g_landed[mi].Reset(m.Cols(), m.Rows());
+        g_occupancy[mi].Reset(m.Cols(), m.Rows());
+    }
+    g_changedCells.clear();
+    g_changedBands.clear();
+    BuildMonitorGroups();
+
+    // create streams — per-monitor: tetromino streams + tail-only streams.
+    // Size every array and tail arena up front; nothing is allocated later.
+    StreamSet& st = g_streams;
+    int numStreams = 0, arenaSize = 0, maxTail = 0;
+    std::vector<int> monStreams(g_monitors.size()), monPieceStreams(g_monitors.size());
+    for (int mi = 0; mi < (int)g_monitors.size(); mi++) {
+        const auto& m = g_monitors[mi];
+        int numPieceStreams = m.Cols();
+        if (numPieceStreams < 15) numPieceStreams = 15;
+        monPieceStreams[mi] = numPieceStreams;
+        monStreams[mi] = numPieceStreams + numPieceStreams / 2;
+        numStreams += monStreams[mi];
+        int monMaxTail = MaxTailLength(0.0f, m.Rows());
+        arenaSize += monStreams[mi] * monMaxTail;
+        if (monMaxTail > maxTail) maxTail = monMaxTail;
+    }
+    g_tailGradients.Build(maxTail);
+    st.y.assign(numStreams, 0.0f);
+    st.prevY.assign(numStreams, 0.0f);
+    st.speed.assign(numStreams, 0.0f);
+    st.col.assign(numStreams, 0);
+    st.length.assign(numStreams, 0);
+    st.ticksToRotate.assign(numStreams, 0);
+    st.ticksToHardDrop.assign(numStreams, 0);
+    st.changedChar.assign(numStreams, -1);
+    st.pieceType.assign(numStreams, 0);
+    st.rotation.assign(numStreams, 0);
+    st.hasPiece.assign(numStreams, 0);
+    st.hardDropping.assign(numStreams, 0);
+    st.respawned.assign(numStreams, 1);
+    st.monitorIdx.assign(numStreams, 0);
+    st.origSpeed.assign(numStreams, 0.0f);
+    st.tailBase.assign(numStreams, 0);
+    st.gradientBase.assign(numStreams, 0);
+    st.drawPx.assign(numStreams, 0);
+    st.drawCol.assign(numStreams, 0);
+    st.chars.assign(arenaSize, L' ');
+    g_streamRolls.assign(numStreams, 0);
+
+    // Each monitor draws from its own generator, seeded from the run's seed
+    g_monitorRng.resize(g_monitors.size());
+    for (int mi = 0; mi < (int)g_monitors.size(); mi++) g_monitorRng[mi].Seed(seed, mi);
+
+    // Streams are laid out monitor by monitor
+    g_monitorFirstStream.assign(g_monitors.size() + 1, 0);
+    g_monitorFirstTail.assign(g_monitors.size(), 0);
+    int si = 0, base = 0;
+    for (int mi = 0; mi < (int)g_monitors.size(); mi++) {
+        auto& m = g_monitors[mi];
+        int monW = m.Cols(), monH = m.Rows();
+        Rng& rng = g_monitorRng[mi];
+        g_monitorFirstStream[mi] = si;
+        g_monitorFirstTail[mi] = si + monPieceStreams[mi];
+        for (int i = 0; i < monStreams[mi]; i++, si++) {
+            st.monitorIdx[si] = mi;
+            st.hasPiece[si]   = (i < monPieceStreams[mi]);
+            st.tailBase[si]   = base;
+            base += MaxTailLength(0.0f, monH);
+            st.col[si]    = rng.Int(0, monW - 1);
+            st.y[si]      = rng.Float(-20.0f, 0.0f);
+            st.speed[si]  = rng.Float(0.08f, 1.2f);
+            st.length[si] = rng.Int(6, MaxTailLength(st.speed[si], monH));
+            wchar_t* chars = st.Chars(si);
+            for (int j = 0; j < st.length[si]; j++) chars[j] = RandMatrixChar(rng);
+            st.pieceType[si]       = (uint8_t)rng.Int(0, 6);
+            st.rotation[si]        = (uint8_t)rng.Int(0, 3);
+            st.ticksToRotate[si]   = rng.Int(10, 50);
+            st.hardDropping[si]    = 0;
+            st.origSpeed[si]       = st.speed[si];
+            st.ticksToHardDrop[si] = rng.Int(200, 800);
+            st.gradientBase[si]    = g_tailGradients.Get(st.length[si]);
+            st.prevY[si]           = st.y[si];
+            st.drawPx[si]          = (m.top + (int)st.y[si]) * CELL;
+            st.drawCol[si]         = m.left + st.col[si];
+        }
+    }
+    g_monitorFirstStream[g_monitors.size()] = si;
+
+    // Init per-monitor fill tracking (grid starts empty)
+    g_monitorFill.assign(g_monitors.size(), MonitorFill());
+    for (int i = 0; i < (int)g_monitors.size(); i++) {
+        const auto& m = g_monitors[i];
+        g_monitorFill[i].rowCount.assign(m.Rows(), 0);
+        g_monitorFill[i].filledRows = 0;
+        g_monitorFill[i].topRow = m.Rows();
+        g_monitorFill[i].colTop.assign(m.Cols(), m.Rows());
+    }
+
+    // Init per-monitor clear tracking
+    g_monitorClears.assign(g_monitors.size(), MonitorClearInfo());
+    for (int i = 0; i < (int)g_monitors.size(); i++) {
+        g_monitorClears[i].monIdx = i;
+        g_monitorClears[i].phase = CLEAR_IDLE;
+        g_monitorClears[i].flashTick = 0;
+        g_monitorClears[i].dropOffset = 0.0f;
+        g_monitorClears[i].prevDropOffset = 0.0f;
+        g_monitorClears[i].drawDropOffset = 0;
+        g_monitorClears[i].dropTarget = 0.0f;
+        g_monitorClears[i].lowestRow = -1;
+        g_monitorClears[i].highestRow = -1;
+    }
+
+    StartWorkers();
+}
+
+// ─── Fill-level tracking ─────────────────────────────────────────────────────
+
+// Record a new filled-cell count for row r of monitor mi
+static void SetRowFill(int mi, int r, int count) {
+    auto& f = g_monitorFill[mi];
+    int& slot = f.rowCount[r];
+    if (slot == count) return;
+    if (slot == 0) f.filledRows++;
+    if (count == 0) f.filledRows--;
+    slot = count;
+    if (count > 0) {
+        if (r < f.topRow) f.topRow = r;
+    } else if (r == f.topRow) {
+        // Topmost row emptied: walk down to the next row with content
+        int next = r + 1;
+        while (next < (int)f.rowCount.size() && f.rowCount[next] == 0) next++;
+        f.topRow = next;
+    }
+}
+
+// Cell (r, c) of monitor mi just became filled
+static void OnCellFilled(int mi, int r, int c) {
+    auto& f = g_monitorFill[mi];
+    SetRowFill(mi, r, f.rowCount[r] + 1);
+    if (r < f.colTop[c]) f.colTop[c] = r;
+}
+
+// Row r of monitor mi was rewritten; recount it
+static void OnRowChanged(int mi, int r) {
+    SetRowFill(mi, r, g_occupancy[mi].RowCount(r, 0, g_occupancy[mi].cols));
+}
+
+// Recompute monitor mi's skyline after rows were cleared or shifted: scan
+// down from the topmost content until every column has been seen
+static void RebuildSkyline(int mi) {
+    auto& f = g_monitorFill[mi];
+    const OccupancyGrid& occ = g_occupancy[mi];
+    int rows = occ.rows;
+    int unseen = (int)f.colTop.size();
+    f.colTop.assign(unseen, rows);
+    for (int r = f.topRow; r < rows && unseen > 0; r++) {
+        const uint64_t* row = occ.Row(r);
+        for (int w = 0; w < occ.wordsPerRow; w++) {
+            uint64_t bits = row[w];
+            while (bits) {
+                int& top = f.colTop[w * 64 + CountTrailingZeros64(bits)];
+                bits &= bits - 1;
+                if (top == rows) {
+                    top = r;
+                    unseen--;
+                }
+            }
+        }
+    }
+}
+
+// Rows of monitor monIdx were rewritten; monitors overlapping it share
+// cells and are in the same group
+static void RebuildGroupSkylines(int monIdx) {
+    for (int mi : g_monitorGroups[g_groupOf[monIdx]].monitors) RebuildSkyline(mi);
+}
+
+float GetMonitorFillPct(int monIdx) {
+    int monH = g_monitors[monIdx].Rows();
+    if (monH <= 0) return 0.0f;
+    return (float)g_monitorFill[monIdx].filledRows / (float)monH;
+}
+
+// ─── Landed cells ────────────────────────────────────────────────────────────
+// A cell shared by overlapping monitors has a copy in each of them; every
+// write goes to all copies
+
+// Cell (r, c) of monitor mi in monitor mj's coordinates; false if mj doesn't cover it
+static bool MapCell(int mi, int r, int c, int mj, int& rj, int& cj) {
+    const auto& a = g_monitors[mi];
+    const auto& b = g_monitors[mj];
+    rj = a.top + r - b.top;
+    cj = a.left + c - b.left;
+    return rj >= 0 && rj < b.Rows() && cj >= 0 && cj < b.Cols();
+}
+
+// Write cell (r, c) of monitor mi, and its copies on the rest of the group
+static void StoreCell(int mi, int r, int c, LandedCell cell) {
+    for (int mj : g_monitorGroups[g_groupOf[mi]].monitors) {
+        int rj, cj;
+        if (!MapCell(mi, r, c, mj, rj, cj)) continue;
+        g_landed[mj].At(rj, cj) = cell;
+        if (cell.Filled() && !g_occupancy[mj].Test(rj, cj)) {
+            g_occupancy[mj].Set(rj, cj);
+            OnCellFilled(mj, rj, cj);
+        }
+    }
+}
+
+// Rows [firstRow, lastRow] of monitor mi were rewritten; copy the part other
+// monitors share into their grids
+static void SyncSharedRows(int mi, int firstRow, int lastRow) {
+    const auto& a = g_monitors[mi];
+    for (int mj : g_monitorGroups[g_groupOf[mi]].monitors) {
+        if (mj == mi) continue;
+        const auto& b = g_monitors[mj];
+        int left = std::max(a.left, b.left), right = std::min(a.right, b.right);
+        int top = std::max(a.top + firstRow, b.top), bottom = std::min(a.top + lastRow + 1, b.bottom);
+        for (int y = top; left < right && y < bottom; y++) {
+            const LandedCell* src = g_landed[mi].Row(y - a.top) + (left - a.left);
+            LandedCell* dst = g_landed[mj].Row(y - b.top) + (left - b.left);
+            OccupancyGrid& occ = g_occupancy[mj];
+            for (int x = 0; x < right - left; x++) {
+                dst[x] = src[x];
+                if (src[x].Filled()) {
+                    occ.Set(y - b.top, left - b.left + x);
+                } else {
+                    occ.Clear(y - b.top, left - b.left + x);
+                }
+            }
+            OnRowChanged(mj, y - b.top);
+        }
+    }
+}
+
+// ─── Check if piece can land ─────────────────────────────────────────────────
+
+static bool CanPieceFitAt(int pieceType, int rotation, int row, int col, int monIdx) {
+    const PieceShape& sh = PIECE_SHAPES[pieceType][rotation];
+    const OccupancyGrid& occ = g_occupancy[monIdx];
+    int boxLeft = col - 1; // center the piece on the column
+    // Columns of the 4-wide box that lie on this monitor; the rest are clipped
+    uint32_t clip = 0;
+    for (int c = sh.leftCol; c <= sh.rightCol; c++) {
+        int bc = boxLeft + c;
+        if (bc >= 0 && bc < occ.cols) clip |= 1u << c;
+    }
+    for (int r = sh.topRow; r <= sh.bottomRow; r++) {
+        uint32_t bits = sh.rowBits[r] & clip;
+        if (!bits) continue;
+        int br = row + r;
+        if (br < 0) continue;                              // above this monitor: skip
+        if (br >= occ.rows) return false;                  // below this monitor's floor
+        if (bits & occ.Bits4(br, boxLeft)) return false;   // hit a landed block
+    }
+    return true;
+}
+
+// First row at which a piece dropped straight down from above the skyline
+// touches a landed cell or the monitor floor: the smallest gap between a
+// column's height and the piece's lowest cell in that column. INT_MAX if no
+// column of the piece is on the monitor.
+static int SkylineHitRow(int pieceType, int rotation, int col, int monIdx) {
+    const PieceShape& sh = PIECE_SHAPES[pieceType][rotation];
+    const std::vector<int>& colTop = g_monitorFill[monIdx].colTop;
+    int boxLeft = col - 1;
+    int hit = INT_MAX;
+    for (int c = sh.leftCol; c <= sh.rightCol; c++) {
+        int bc = boxLeft + c;
+        if (bc < 0 || bc >= (int)colTop.size() || sh.colBottom[c] < 0) continue;
+        hit = std::min(hit, colTop[bc] - sh.colBottom[c]);
+    }
+    return hit;
+}
+
+static void LandPiece(int si) {
+    const StreamSet& st = g_streams;
+    int mi = st.monitorIdx[si];
+    int headRow = (int)st.y[si];
+    int pieceCol = st.col[si];
+    const PieceShape& sh = PIECE_SHAPES[st.pieceType[si]][st.rotation[si]];
+    // Cells hanging off the monitor are dropped, as they were never drawn while
+    // falling, and this keeps each monitor's landed cells to its own group
+    const LandedGrid& landed = g_landed[mi];
+    MonitorGroup& grp = g_monitorGroups[g_groupOf[mi]];
+    for (int i = 0; i < 4; i++) {
+        int r = headRow + sh.cellRow[i];
+        int c = pieceCol + sh.cellCol[i] - 1;
+        if (r >= 0 && r < landed.rows && c >= 0 && c < landed.cols) {
+            // A cell that is still glowing is already on the fade list
+            if (!landed.At(r, c).Glow()) grp.glowCells.push_back({mi, r, c});
+            grp.changedCells.push_back({mi, r, c});
+            StoreCell(mi, r, c, LandedCell::Landed(st.pieceType[si]));
+        }
+    }
+}
+
+// ─── Tail gradients ──────────────────────────────────────────────────────────
+
+void TailGradients::Build(int maxLength) {
+    if ((int)base.size() <= maxLength) base.resize(maxLength + 1, -1);
+    for (int length = 1; length <= maxLength; length++) {
+        if (base[length] >= 0) continue;
+        // Append the gradient for this length
+        int offset = (int)colors.size();
+        base[length] = offset;
+        colors.resize(offset + length);
+        shades.resize(offset + length);
+        for (int i = 0; i < length; i++) {
+            float t = (float)i / (float)length;
+            float exp_t = t * t; // quadratic curve
+            int colorIdx = (int)(exp_t * (NUM_GREENS - 1));
+            if (colorIdx >= NUM_GREENS) colorIdx = NUM_GREENS - 1;
+            // First few characters (head) are extra bright / near-white
+            if (i <= 2) {
+                colorIdx = NUM_GREENS + (i == 0 ? 0 : 1);
+            }
+            colors[offset + i] = TailShade(colorIdx);
+            shades[offset + i] = (uint8_t)colorIdx;
+        }
+    }
+}
+
+static void ResetStream(int si) {
+    // Respawn within same monitor, keep same stream type (piece vs tail-only)
+    StreamSet& st = g_streams;
+    auto& m = g_monitors[st.monitorIdx[si]];
+    int monH = m.Rows();
+    Rng& rng = g_monitorRng[st.monitorIdx[si]];
+    st.col[si]    = rng.Int(0, m.Cols() - 1);
+    st.y[si]      = rng.Float(-20.0f, -4.0f);
+    st.speed[si]  = rng.Float(0.08f, 1.2f);
+    st.length[si] = rng.Int(6, MaxTailLength(st.speed[si], monH));
+    wchar_t* chars = st.Chars(si);
+    for (int j = 0; j < st.length[si]; j++) chars[j] = RandMatrixChar(rng);
+    if (g_maxTailLength > 0) st.length[si] = std::min(st.length[si], g_maxTailLength);
+    st.pieceType[si]       = (uint8_t)rng.Int(0, 6);
+    st.rotation[si]        = (uint8_t)rng.Int(0, 3);
+    st.ticksToRotate[si]   = rng.Int(10, 50);
+    st.hardDropping[si]    = 0;
+    st.origSpeed[si]       = st.speed[si];
+    st.ticksToHardDrop[si] = rng.Int(200, 800);
+    st.gradientBase[si]    = g_tailGradients.Get(st.length[si]);
+    st.respawned[si]       = 1;
+}
+
+// Stream has left its monitor: fallen past the floor with its whole tail
+static bool PastFloor(int si, int monH) {
+    const StreamSet& st = g_streams;
+    return (int)st.y[si] - st.length[si] > monH + 10;
+}
+
+// Take a stream off screen until it runs again. It is placed past the floor,
+// where the first tick it runs respawns it.
+static void ParkStream(int si, int monH) {
+    StreamSet& st = g_streams;
+    st.y[si] = st.prevY[si] = (float)(monH + st.length[si] + 11);
+    st.respawned[si] = 1;
+}
+
+void SetStreamQuality(float tailStreamShare, int maxTailLength) {
+    g_tailStreamShare = std::min(std::max(tailStreamShare, 0.0f), 1.0f);
+    g_maxTailLength = std::max(maxTailLength, 0);
+}
+
+// ─── Row clearing ────────────────────────────────────────────────────────────
+
+static void StartClearForMonitor(MonitorClearInfo& mci) {
+    const auto& fill = g_monitorFill[mci.monIdx];
+    mci.dropOffset = 0.0f;
+    mci.lowestRow = -1;
+    mci.highestRow = -1;
+    // Search from monitor's bottom upward for rows with content
+    std::vector<int> contentRows;
+    for (int r = (int)fill.rowCount.size() - 1; r >= fill.topRow && (int)contentRows.size() < ROWS_TO_CLEAR; r--) {
+        if (fill.rowCount[r] > 0) {
+            contentRows.push_back(r);
+        }
+    }
+    if (contentRows.empty()) return;
+    // contentRows[0] = lowest (bottom-most), contentRows.back() = highest (top-most)
+    mci.lowestRow  = contentRows[0];
+    mci.highestRow = contentRows.back();
+    // Build the full contiguous span from highestRow to lowestRow
+    mci.rows.clear();
+    for (int r = mci.highestRow; r <= mci.lowestRow; r++) {
+        mci.rows.push_back(r);
+    }
+    int span = mci.lowestRow - mci.highestRow + 1;
+    mci.dropTarget = (float)(span * CELL);
+    mci.phase = CLEAR_FLASH;
+    mci.flashTick = 20;
+}
+
+static void ApplyClearAndStartDrop(MonitorClearInfo& mci) {
+    // Clear the marked rows within this monitor
+    OccupancyGrid& occ = g_occupancy[mci.monIdx];
+    for (int r : mci.rows) {
+        g_landed[mci.monIdx].ClearRow(r);
+        occ.ClearRowSpan(r, 0, occ.cols);
+        OnRowChanged(mci.monIdx, r);
+    }
+    SyncSharedRows(mci.monIdx, mci.highestRow, mci.lowestRow);
+    RebuildGroupSkylines(mci.monIdx);
+    g_monitorGroups[g_groupOf[mci.monIdx]].changedBands.push_back({mci.monIdx, mci.highestRow, mci.lowestRow});
+    mci.dropOffset = 0.0f;
+    mci.prevDropOffset = 0.0f;
+    mci.phase = CLEAR_DROP;
+}
+
+static void ApplyGravityForMonitor(int monIdx, int numRows) {
+    // Structure-preserving shift: move all rows above the cleared zone
+    // down by numRows, keeping their relative positions intact. The cleared
+    // rows' slots are reused for the rows vacated at the top.
+    OccupancyGrid& occ = g_occupancy[monIdx];
+    int rows = occ.rows;
+    int topContent = g_monitorFill[monIdx].topRow;
+    if (topContent < rows) {
+        g_landed[monIdx].ShiftDown(topContent, std::min(numRows, rows - topContent));
+    }
+    // Occupancy bits are shifted word by word, bottom to top to avoid overwriting
+    for (int r = rows - 1; r >= topContent + numRows; r--) {
+        occ.CopyRowSpan(r, r - numRows, 0, occ.cols);
+        OnRowChanged(monIdx, r);
+    }
+    for (int r = topContent; r < topContent + numRows && r < rows; r++) {
+        occ.ClearRowSpan(r, 0, occ.cols);
+        OnRowChanged(monIdx, r);
+    }
+    SyncSharedRows(monIdx, topContent, rows - 1);
+    RebuildGroupSkylines(monIdx);
+    MonitorGroup& grp = g_monitorGroups[g_groupOf[monIdx]];
+    grp.changedBands.push_back({monIdx, topContent, rows - 1});
+    // Glowing cells in the shifted band moved with their rows; ones pushed past
+    // the floor were overwritten. Cells listed under an overlapping monitor
+    // are moved if this monitor covers them.
+    std::vector<CellPos>& glow = grp.glowCells;
+    for (size_t i = 0; i < glow.size();) {
+        CellPos& p = glow[i];
+        int r, c;
+        if (MapCell(p.monIdx, p.row, p.col, monIdx, r, c) && r >= topContent) {
+            p = {monIdx, r + numRows, c};
+            if (p.row >= rows) {
+                p = glow.back();
+                glow.pop_back();
+                continue;
+            }
+        }
+        i++;
+    }
+}
+
+// ─── Update ──────────────────────────────────────────────────────────────────
+
+static void UpdateMonitorClears(int monIdx) {
+    // ── Per-monitor row clearing state machine ────────────────────────
+    MonitorClearInfo& mci = g_monitorClears[monIdx];
+    mci.prevDropOffset = mci.dropOffset;
+    if (mci.phase == CLEAR_IDLE) {
+        // Check if this monitor has reached the fill threshold
+        float fillPct = GetMonitorFillPct(monIdx);
+        if (fillPct >= FILL_CLEAR_PCT) {
+            StartClearForMonitor(mci);
+        }
+    } else if (mci.phase == CLEAR_FLASH) {
+        mci.flashTick--;
+        if (mci.flashTick <= 0) {
+            ApplyClearAndStartDrop(mci);
+        }
+    } else if (mci.phase == CLEAR_DROP) {
+        if (mci.dropOffset < mci.dropTarget) {
+            float dropSpeed = 3.0f + mci.dropOffset * 0.05f;
+            mci.dropOffset += dropSpeed;
+            if (mci.dropOffset >= mci.dropTarget) {
+                mci.dropOffset = mci.dropTarget;
+                ApplyGravityForMonitor(mci.monIdx, (int)mci.rows.size());
+                mci.phase = CLEAR_IDLE;
+            }
+        } else {
+            mci.phase = CLEAR_IDLE;
+        }
+    }
+}
+
+static void UpdateMonitorStreams(int monIdx) {
+    StreamSet& st = g_streams;
+    Rng& rng = g_monitorRng[monIdx];
+    int first = g_monitorFirstStream[monIdx];
+    int end   = g_monitorFirstStream[monIdx + 1];
+    int monH  = g_monitors[monIdx].Rows();
+    // Tail-only streams past the governor's share are parked
+    int firstTail = g_monitorFirstTail[monIdx];
+    int runEnd = firstTail + (int)((end - firstTail) * g_tailStreamShare + 0.5f);
+
+    // Per-tick rolls for every stream of this monitor in one batch
+    rng.Fill(&g_streamRolls[first], end - first);
+
+    // Check if this monitor is currently clearing
+    bool monitorClearing = false;
+    if (monIdx < (int)g_monitorClears.size()) {
+        monitorClearing = (g_monitorClears[monIdx].phase != CLEAR_IDLE);
+    }
+    float speedMul = monitorClearing ? 0.20f : 1.0f;
+
+    for (int si = first; si < end; si++) {
+        st.changedChar[si] = -1;
+        st.respawned[si]   = 0;
+        st.prevY[si]       = st.y[si];
+        if (si >= runEnd) {
+            if (!PastFloor(si, monH)) ParkStream(si, monH);
+            continue;
+        }
+
+        // Rotation timer — only for piece streams
+        if (st.hasPiece[si]) {
+            st.ticksToRotate[si]--;
+            if (st.ticksToRotate[si] <= 0) {
+                int newRot = (st.rotation[si] + rng.Int(1, 3)) % 4;
+                if (CanPieceFitAt(st.pieceType[si], newRot, (int)st.y[si], st.col[si], monIdx)) {
+                    st.rotation[si] = (uint8_t)newRot;
+                }
+                st.ticksToRotate[si] = rng.Int(10, 50);
+            }
+
+            // Hard drop trigger
+            if (!st.hardDropping[si]) {
+                st.ticksToHardDrop[si]--;
+                if (st.ticksToHardDrop[si] <= 0) {
+                    st.hardDropping[si] = 1;
+                    st.origSpeed[si] = st.speed[si];
+                    st.speed[si] = rng.Float(1.5f, 5.0f); // very fast
+                }
+            }
+        }
+
+        // Move — every row passed through is checked so fast pieces can't
+        // skip through blocks
+        float y = st.y[si];
+        float newY = y + st.speed[si] * speedMul;
+        int startRow = (int)y;
+        int endRow   = (int)newY;
+        int length   = st.length[si];
+
+        // Randomly change a character in the tail. A roll under the limit,
+        // scaled back up to the full 32-bit range, also picks the character.
+        uint32_t roll = g_streamRolls[si];
+        if (roll < MUTATE_ROLL_LIMIT && length > 0) {
+            int idx = (int)(((uint64_t)(roll * 5u) * (uint32_t)length) >> 32);
+            st.Chars(si)[idx] = RandMatrixChar(rng);
+            st.changedChar[si] = idx;
+        }
+
+        // A tail over the cap is cut short; its head stays where it is
+        if (g_maxTailLength > 0 && length > g_maxTailLength) {
+            length = st.length[si] = g_maxTailLength;
+            st.gradientBase[si] = g_tailGradients.Get(length);
+            st.changedChar[si] = SEVERAL_CHARS_CHANGED;
+        }
+
+        // Tail-only streams: just move and wrap, no collision
+        if (!st.hasPiece[si]) {
+            st.y[si] = newY;
+            if (PastFloor(si, monH)) {
+                ResetStream(si);
+            }
+            continue;
+        }
+
+        // ── Collision detection: first blocked row in checkFrom..endRow ──
+        if (endRow >= -3) {
+            // Make sure we check from at least startRow
+            int checkFrom = (startRow < -3) ? -3 : startRow;
+            int landRow = -999;
+            int pieceType = st.pieceType[si], rotation = st.rotation[si], col = st.col[si];
+            {
+                ProfileScope prof(PROF_COLLISION);
+                int hitRow = SkylineHitRow(pieceType, rotation, col, monIdx);
+                if (checkFrom < hitRow) {
+                    // Still above the skyline: every row before hitRow fits
+                    // and hitRow itself doesn't
+                    if (hitRow <= endRow) landRow = hitRow - 1;
+                } else {
+                    // Level with or under an overhang (after a rotation or a
+                    // gravity shift): step through each row
+                    for (int testRow = checkFrom; testRow <= endRow; testRow++) {
+                        if (!CanPieceFitAt(pieceType, rotation, testRow, col, monIdx)) {
+                            landRow = testRow - 1;  // last row that fit
+                            break;
+                        }
+                    }
+                }
+            }
+            if (landRow != -999) {
+                // Land the piece at the last valid row
+                if (landRow >= -3) {
+                    st.y[si] = (float)landRow;
+                    // Filled rows are contiguous, so the piece is on screen if its
+                    // top..bottom span overlaps the monitor
+                    const PieceShape& sh = PIECE_SHAPES[pieceType][rotation];
+                    bool anyOnScreen = landRow + sh.bottomRow >= 0 && landRow + sh.topRow < monH;
+                    if (anyOnScreen) LandPiece(si);
+                }
+                ResetStream(si);
+                continue;
+            }
+        }
+        st.y[si] = newY;
+
+        // If stream has gone fully off screen (past its monitor's floor)
+        if (PastFloor(si, monH)) {
+            ResetStream(si);
+        }
+    }
+}
+
+static void FadeGroup(MonitorGroup& grp) {
+    // Fade brightness of recently landed cells; cells reaching the floor (or
+    // cleared since they landed) drop off the list
+    std::vector<CellPos>& glow = grp.glowCells;
+    for (size_t i = 0; i < glow.size();) {
+        CellPos p = glow[i];
+        LandedCell cell = g_landed[p.monIdx].At(p.row, p.col);
+        if (cell.Glow()) {
+            cell.Fade();
+            StoreCell(p.monIdx, p.row, p.col, cell);
+            grp.changedCells.push_back(p);
+        }
+        if (!cell.Glow()) {
+            glow[i] = glow.back();
+            glow.pop_back();
+            continue;
+        }
+        i++;
+    }
+}
+
+// ─── Per-group phases ────────────────────────────────────────────────────────
+// Each runs as one task of a parallel-for over g_monitorGroups
+
+static void ClearsTask(int gi) {
+    for (int mi : g_monitorGroups[gi].monitors) UpdateMonitorClears(mi);
+}
+
+static void StreamsTask(int gi) {
+    for (int mi : g_monitorGroups[gi].monitors) UpdateMonitorStreams(mi);
+}
+
+static void FadeTask(int gi) {
+    FadeGroup(g_monitorGroups[gi]);
+}
+
+static void TickTask(int gi) {
+    ClearsTask(gi);
+    StreamsTask(gi);
+    FadeTask(gi);
+}
+
+void UpdateClears() {
+    ProfileScope prof(PROF_ROW_CLEARS);
+    g_workers.ParallelFor((int)g_monitorGroups.size(), ClearsTask);
+    CollectGroupChanges();
+}
+
+void UpdateStreams() {
+    ProfileScope prof(PROF_STREAMS);
+    g_workers.ParallelFor((int)g_monitorGroups.size(), StreamsTask);
+    CollectGroupChanges();
+}
+
+void FadeLanded() {
+    ProfileScope prof(PROF_FADE);
+    g_workers.ParallelFor((int)g_monitorGroups.size(), FadeTask);
+    CollectGroupChanges();
+}
+
+void BeginTick() {
+    g_changedCells.clear();
+    g_changedBands.clear();
+}
+
+void Update() {
+    BeginTick();
+    if (g_profiler.enabled) {
+        // One parallel pass per phase, so each can be timed
+        UpdateClears();
+        UpdateStreams();
+        FadeLanded();
+        return;
+    }
+    // All groups run the whole tick at once; the join is before anything
+    // reads the results
+    g_workers.ParallelFor((int)g_monitorGroups.size(), TickTask);
+    CollectGroupChanges();
+}
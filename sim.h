@@ -0,0 +1,341 @@
+// Matrix Tetris simulation core
+// Platform-independent state for the screensaver: Matrix streams, the landed
+// Tetris grid and the per-monitor row-clear state machine.
+// Nothing in here touches GDI or Win32, so the simulation can be driven
+// headlessly (see bench.cpp) as well as by the screensaver front end (main.cpp).
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "glyphs.h"
+#include "occupancy.h"
+#include "pieces.h"
+#include "rng.h"
+
+// ─── Colors ──────────────────────────────────────────────────────────────────
+
+// 0x00BBGGRR — same layout as a Win32 COLORREF, so values pass straight to GDI
+typedef uint32_t Color;
+
+constexpr Color MakeColor(int r, int g, int b) {
+    return (Color)(r & 0xFF) | ((Color)(g & 0xFF) << 8) | ((Color)(b & 0xFF) << 16);
+}
+constexpr int ColorR(Color c) { return (int)(c & 0xFF); }
+constexpr int ColorG(Color c) { return (int)((c >> 8) & 0xFF); }
+constexpr int ColorB(Color c) { return (int)((c >> 16) & 0xFF); }
+
+// Scale a color's channels by brightness / 255
+constexpr Color DimColor(Color base, int brightness) {
+    return MakeColor(ColorR(base) * brightness / 255,
+                     ColorG(base) * brightness / 255,
+                     ColorB(base) * brightness / 255);
+}
+
+// ─── Constants ───────────────────────────────────────────────────────────────
+
+static const int     CELL           = 16;        // pixel size of one grid cell
+static const float   FILL_CLEAR_PCT = 0.30f;      // trigger clear when a monitor reaches 30% fill
+static const int     ROWS_TO_CLEAR  = 4;
+
+// Matrix green palette (exponential curve: bright head → dark green tail)
+static const Color MATRIX_GREENS[] = {
+    MakeColor(218, 255, 228),   // 0 – bright white-green (very tip)
+    MakeColor(120, 255, 160),   // 1 – bright green-white
+    MakeColor(60, 255, 120),    // 2 – vivid bright green
+    MakeColor(20, 250, 90),     // 3 – bright green
+    MakeColor(0, 230, 75),      // 4 – strong green
+    MakeColor(0, 200, 60),      // 5
+    MakeColor(0, 165, 48),      // 6
+    MakeColor(0, 130, 36),      // 7
+    MakeColor(0, 95, 26),       // 8
+    MakeColor(0, 65, 18),       // 9
+    MakeColor(0, 42, 11),       // 10
+    MakeColor(0, 28, 7),        // 11 – very dark
+};
+static const int NUM_GREENS = sizeof(MATRIX_GREENS) / sizeof(MATRIX_GREENS[0]);
+
+// Extra-bright shades for the first characters of a tail
+static const Color HEAD_GREENS[] = {
+    MakeColor(240, 255, 245),   // head character
+    MakeColor(200, 255, 215),   // the two just behind it
+};
+
+// Every shade a tail character can take: MATRIX_GREENS then HEAD_GREENS.
+// TailGradients::shades index this, so glyph caches can pre-render
+// one row per shade.
+static const int NUM_TAIL_SHADES = NUM_GREENS + (int)(sizeof(HEAD_GREENS) / sizeof(HEAD_GREENS[0]));
+static inline Color TailShade(int idx) {
+    return idx < NUM_GREENS ? MATRIX_GREENS[idx] : HEAD_GREENS[idx - NUM_GREENS];
+}
+
+// Tetris piece colors (all given a green/matrix tint)
+static constexpr Color TETRIS_COLORS[] = {
+    MakeColor(0, 255, 100),   // I  – bright green
+    MakeColor(0, 200, 80),    // O  – medium green
+    MakeColor(50, 255, 130),  // T  – lime
+    MakeColor(0, 180, 60),    // S  – forest
+    MakeColor(30, 230, 90),   // Z  – emerald
+    MakeColor(0, 160, 70),    // J  – teal-green
+    MakeColor(80, 255, 140),  // L  – mint
+};
+static const int NUM_PIECE_COLORS = sizeof(TETRIS_COLORS) / sizeof(TETRIS_COLORS[0]);
+
+// ─── Tail gradients ──────────────────────────────────────────────────────────
+// A tail's color gradient depends only on its length, so all streams of one
+// length share a single copy, referenced by offset. Every length a monitor can
+// spawn is built up front, so lookups never write and renderers on other
+// threads can read the gradients freely.
+
+struct TailGradients {
+    std::vector<int>     base;    // [length] -> offset into colors/shades, -1 until built
+    std::vector<Color>   colors;  // [base + j] for j < length, j = 0 is the head
+    std::vector<uint8_t> shades;  // TailShade index of each color, for cache lookup
+
+    // Build the gradients of every length up to maxLength
+    void Build(int maxLength);
+    // Offset of the gradient for length (<= the longest built)
+    int Get(int length) const { return base[length]; }
+};
+
+extern TailGradients g_tailGradients;
+
+// ─── Matrix rain character streams ───────────────────────────────────────────
+// Streams are stored as parallel arrays indexed by stream number, so the
+// per-tick loop walks tightly packed fields. Tail characters live in a shared
+// arena where each stream owns a slot sized for the longest tail its monitor
+// can spawn, so respawning never touches the heap.
+
+// changedChar of a stream whose tail was rewritten as a whole (cut short, or
+// mutated more than once between two snapshots)
+static const int SEVERAL_CHARS_CHANGED = -2;
+
+struct StreamSet {
+    // Hot: read or written every tick
+    std::vector<float>   y;                // current head position (row on its monitor, fractional)
+    std::vector<float>   prevY;            // y at the start of the last tick, for interpolation
+    std::vector<float>   speed;            // cells per tick
+    std::vector<int>     col;              // column on its monitor
+    std::vector<int>     length;           // tail length in cells
+    std::vector<int>     ticksToRotate;    // ticks until next rotation change
+    std::vector<int>     ticksToHardDrop;  // ticks until a hard-drop triggers
+    std::vector<int>     changedChar;      // tail character mutated this tick, -1 if none
+    std::vector<uint8_t> pieceType;        // 0-6
+    std::vector<uint8_t> rotation;         // 0-3
+    std::vector<uint8_t> hasPiece;         // 0 = tail-only stream (no tetromino)
+    std::vector<uint8_t> hardDropping;     // currently doing a fast drop
+    std::vector<uint8_t> respawned;        // ResetStream ran this tick, or the stream was parked
+
+    // Cold: touched on respawn and by renderers
+    std::vector<int>     monitorIdx;       // which monitor this stream belongs to
+    std::vector<float>   origSpeed;        // speed before hard-drop
+    std::vector<int>     tailBase;         // start of this stream's slot in chars
+    std::vector<int>     gradientBase;     // this length's gradient in g_tailGradients
+    std::vector<int>     drawPx;           // screen pixel y of the head row as drawn (SimSnapshot::Interpolate)
+    std::vector<int>     drawCol;          // virtual-screen grid column (SimSnapshot::Interpolate)
+
+    // Tail arena: [tailBase[i] + j] for j < length[i], j = 0 is the head
+    std::vector<wchar_t> chars;            // characters in the tail
+
+    int size() const { return (int)y.size(); }
+
+    Color PieceColor(int i) const { return TETRIS_COLORS[pieceType[i]]; }
+    wchar_t* Chars(int i)                      { return &chars[tailBase[i]]; }
+    const wchar_t* Chars(int i) const          { return &chars[tailBase[i]]; }
+    const Color* TailColors(int i) const       { return &g_tailGradients.colors[gradientBase[i]]; }
+    const uint8_t* TailColorIndices(int i) const { return &g_tailGradients.shades[gradientBase[i]]; }
+};
+
+
+// ─── Landed Tetris grid ──────────────────────────────────────────────────────
+
+static const int GLOW_FLOOR = 80;   // landed cells fade from 255 down to this brightness
+static const int GLOW_STEP  = 3;    // brightness lost per tick while fading
+// Fade ticks from landing until the brightness is at or under the floor
+static const int GLOW_STEPS = (255 - GLOW_FLOOR + GLOW_STEP - 1) / GLOW_STEP;
+
+// One landed cell in 16 bits: a filled flag, the piece's TETRIS_COLORS index
+// and the fade ticks it has left. A cell only ever fades from 255 in steps of
+// GLOW_STEP, so the count gives its brightness exactly.
+struct LandedCell {
+    uint16_t bits;  // glow in bits 0-5, palette in 6-8, filled in 9
+
+    static LandedCell Landed(int palette) { return {(uint16_t)(1u << 9 | palette << 6 | GLOW_STEPS)}; }
+
+    bool Filled() const  { return (bits >> 9) & 1; }
+    int  Palette() const { return (bits >> 6) & 7; }
+    int  Glow() const    { return bits & 0x3F; }  // 0 = faded out (or empty)
+    int  Brightness() const { return 255 - GLOW_STEP * (GLOW_STEPS - Glow()); }
+    void Fade()          { bits--; }              // Glow() > 0
+};
+static_assert(GLOW_STEPS < 64 && NUM_PIECE_COLORS <= 8, "LandedCell fields are 6 and 3 bits");
+
+// One monitor's landed cells, in its local coordinates. Each row is a slot of
+// one buffer reached through rowSlot, so shifting the stack down after a clear
+// permutes slot indices instead of copying cells.
+struct LandedGrid {
+    int cols = 0, rows = 0;
+    std::vector<LandedCell> cells;    // [slot * cols + col]
+    std::vector<int>        rowSlot;  // [row] -> slot
+
+    void Reset(int numCols, int numRows) {
+        cols = numCols;
+        rows = numRows;
+        cells.assign((size_t)numCols * numRows, LandedCell{0});
+        rowSlot.resize(numRows);
+        for (int i = 0; i < numRows; i++) rowSlot[i] = i;
+    }
+
+    LandedCell* Row(int r)             { return cells.data() + (size_t)rowSlot[r] * cols; }
+    const LandedCell* Row(int r) const { return cells.data() + (size_t)rowSlot[r] * cols; }
+    LandedCell& At(int r, int c)             { return Row(r)[c]; }
+    const LandedCell& At(int r, int c) const { return Row(r)[c]; }
+
+    void ClearRow(int r) { std::fill(Row(r), Row(r) + cols, LandedCell{0}); }
+
+    // Move rows [first, rows - n) down by n rows. The n bottom rows drop out
+    // and their slots come back empty at the top.
+    void ShiftDown(int first, int n) {
+        auto begin = rowSlot.begin() + first;
+        std::rotate(begin, rowSlot.end() - n, rowSlot.end());
+        for (int r = first; r < first + n; r++) ClearRow(r);
+    }
+};
+
+// How a landed cell is drawn, for every glow level and piece color:
+// LANDED_SHADES[glow][palette]
+struct LandedShade {
+    Color fill;  // block face: the piece color at the cell's brightness
+    Color edge;  // highlight edge, at half that brightness
+};
+
+constexpr std::array<std::array<LandedShade, NUM_PIECE_COLORS>, GLOW_STEPS + 1> MakeLandedShades() {
+    std::array<std::array<LandedShade, NUM_PIECE_COLORS>, GLOW_STEPS + 1> shades = {};
+    for (int g = 0; g <= GLOW_STEPS; g++) {
+        int brightness = 255 - GLOW_STEP * (GLOW_STEPS - g);
+        for (int p = 0; p < NUM_PIECE_COLORS; p++) {
+            shades[g][p] = {DimColor(TETRIS_COLORS[p], brightness),
+                            DimColor(MakeColor(150, 255, 180), brightness / 2)};
+        }
+    }
+    return shades;
+}
+static constexpr std::array<std::array<LandedShade, NUM_PIECE_COLORS>, GLOW_STEPS + 1> LANDED_SHADES = MakeLandedShades();
+
+static inline const LandedShade& LandedCellShade(LandedCell cell) {
+    return LANDED_SHADES[cell.Glow()][cell.Palette()];
+}
+
+// ─── Monitor info ────────────────────────────────────────────────────────────
+
+// Where a monitor sits on the virtual screen. Everything the simulation keeps
+// per monitor is in the monitor's local coordinates (row 0, column 0 at its
+// top left); renderers add the monitor's origin.
+struct MonitorGrid {
+    int left, top, right, bottom;  // virtual-screen grid bounds (inclusive-exclusive)
+
+    int Cols() const { return right > left ? right - left : 0; }
+    int Rows() const { return bottom > top ? bottom - top : 0; }
+};
+
+// A landed cell position (local to the monitor)
+struct CellPos {
+    int monIdx;
+    int row, col;
+};
+
+// Local rows [topRow, bottomRow] of one monitor whose landed cells were
+// rewritten wholesale (cleared, or shifted by gravity)
+struct RowBand {
+    int monIdx;
+    int topRow, bottomRow;
+};
+
+// Per-monitor fill tracking — maintained incrementally as cells land, clear
+// and shift, so fill level, topmost content and column heights are O(1) queries
+struct MonitorFill {
+    std::vector<int> rowCount;  // filled cells per row
+    int filledRows;             // rows with at least one filled cell
+    int topRow;                 // topmost row with content, monitor height if empty
+    std::vector<int> colTop;    // skyline: topmost filled row per column, monitor height if empty
+};
+
+// Per-monitor clear tracking — each monitor clears independently
+enum ClearPhase { CLEAR_IDLE, CLEAR_FLASH, CLEAR_DROP };
+struct MonitorClearInfo {
+    int monIdx;             // which monitor
+    ClearPhase phase;       // per-monitor clear phase
+    int flashTick;          // countdown for flash
+    std::vector<int> rows;  // rows being cleared (local to the monitor)
+    float dropOffset;       // current pixel offset during drop anim
+    float prevDropOffset;   // dropOffset at the start of the last tick
+    int   drawDropOffset;   // pixel offset as drawn (SimSnapshot::Interpolate)
+    float dropTarget;       // target pixel offset
+    int   lowestRow;        // lowest (bottom-most) cleared row
+    int   highestRow;       // highest (top-most) cleared row
+};
+
+// Monitors whose grid rectangles overlap share landed cells (each keeps its
+// own copy of the shared ones), so they are simulated together as one group.
+// Different groups never touch the same cells, streams or generators and are
+// updated in parallel.
+struct alignas(64) MonitorGroup {
+    std::vector<int>     monitors;      // monitor indices, ascending
+    std::vector<CellPos> glowCells;     // landed cells still fading
+    std::vector<CellPos> changedCells;  // this phase's changes, collected into g_changedCells
+    std::vector<RowBand> changedBands;  // collected into g_changedBands
+};
+
+// ─── Simulation state ────────────────────────────────────────────────────────
+
+extern int                                  g_gridCols;
+extern int                                  g_gridRows;
+extern std::vector<MonitorGrid>             g_monitors;
+extern StreamSet                            g_streams;
+extern std::vector<int>                     g_monitorFirstStream; // streams of monitor m are [m] .. [m + 1]
+extern std::vector<Rng>                     g_monitorRng;    // one generator per monitor
+extern std::vector<LandedGrid>              g_landed;    // one per monitor
+extern std::vector<OccupancyGrid>           g_occupancy; // per monitor: filled bits, kept in sync with g_landed
+extern std::vector<MonitorClearInfo>        g_monitorClears; // one per monitor
+extern std::vector<MonitorFill>             g_monitorFill;   // one per monitor
+extern std::vector<MonitorGroup>            g_monitorGroups; // monitors simulated together
+extern std::vector<CellPos>                 g_changedCells;  // cells that landed or faded this tick
+extern std::vector<RowBand>                 g_changedBands;  // row bands cleared or shifted this tick
+
+// ─── Simulation API ──────────────────────────────────────────────────────────
+
+// Size each monitor's landed grid, create its streams and reset clear state.
+// Monitors are placed in virtual-screen grid coordinates and must lie within
+// gridCols × gridRows; only the cells they cover are allocated.
+// The same seed and layout replay the same run tick for tick.
+void InitSimulation(int gridCols, int gridRows, const std::vector<MonitorGrid>& monitors, uint32_t seed);
+
+// Simulate monitor groups on numThreads threads, counting the caller
+// (0 = one per CPU). Takes effect immediately and across InitSimulation.
+void SetSimulationThreads(int numThreads);
+int  GetSimulationThreads();
+
+// Scale the streams back for the quality governor (governor.h), between
+// ticks. Only tailStreamShare of each monitor's tail-only streams run; the
+// rest wait off screen until the share grows again. Tails longer than
+// maxTailLength cells (0 = no cap) are cut short. Takes effect from the next
+// tick and across InitSimulation.
+void SetStreamQuality(float tailStreamShare, int maxTailLength);
+
+// One simulation tick. Equivalent to
+// BeginTick(); UpdateClears(); UpdateStreams(); FadeLanded();
+// but every monitor group runs all three phases in a single parallel pass
+// (unless profiling, which needs the phases apart).
+void Update();
+
+// Individual tick phases, exposed so they can be timed separately
+void BeginTick();      // reset per-tick change records (g_changedCells, g_changedBands)
+void UpdateClears();   // per-monitor row clearing state machine
+void UpdateStreams();  // stream movement, rotation, collision and landing
+void FadeLanded();     // decay the glow of recently landed cells
+
+// Fraction of a monitor's rows that hold at least one landed cell
+float GetMonitorFillPct(int monIdx);
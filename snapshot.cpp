@@ -0,0 +1,90 @@
+// Matrix Tetris simulation snapshots — see snapshot.h
+
+#include "snapshot.h"
+
+#include "profiler.h"
+
+// ─── Interpolation ───────────────────────────────────────────────────────────
+
+void SimSnapshot::Interpolate(float alpha) {
+    // Streams slide between the grid rows of the last two ticks; a respawned
+    // stream has no previous position and is drawn where it is. Positions go
+    // from monitor to virtual-screen coordinates here.
+    StreamSet& st = streams;
+    int numStreams = st.size();
+    for (int si = 0; si < numStreams; si++) {
+        const MonitorGrid& m = g_monitors[st.monitorIdx[si]];
+        int row = (int)st.y[si];
+        int prevRow = st.respawned[si] ? row : (int)st.prevY[si];
+        st.drawPx[si] = (m.top + prevRow) * CELL + (int)((row - prevRow) * CELL * alpha);
+        st.drawCol[si] = m.left + st.col[si];
+    }
+    // Written so that alpha = 1 gives exactly dropOffset
+    for (auto& mci : clears) {
+        mci.drawDropOffset = (int)(mci.dropOffset - (mci.dropOffset - mci.prevDropOffset) * (1.0f - alpha));
+    }
+}
+
+// ─── Triple buffer ───────────────────────────────────────────────────────────
+
+void SnapshotBuffer::ResetPending() {
+    pendingCells.clear();
+    pendingBands.clear();
+    pendingRespawned.assign(g_streams.size(), 0);
+    pendingChangedChar.assign(g_streams.size(), -1);
+}
+
+// Merge the tick that just ran into the pending changes. Re-applying a change
+// the renderer already saw is harmless (everything is redrawn from the
+// snapshot's state), missing one is not.
+void SnapshotBuffer::AddTickChanges() {
+    if ((int)pendingRespawned.size() != g_streams.size()) ResetPending();
+    pendingCells.insert(pendingCells.end(), g_changedCells.begin(), g_changedCells.end());
+    pendingBands.insert(pendingBands.end(), g_changedBands.begin(), g_changedBands.end());
+    const StreamSet& st = g_streams;
+    for (int si = 0; si < st.size(); si++) {
+        if (st.respawned[si]) {
+            pendingRespawned[si] = 1;
+        } else if (st.changedChar[si] != -1) {
+            int& pc = pendingChangedChar[si];
+            pc = (pc == -1 || pc == st.changedChar[si]) ? st.changedChar[si] : SEVERAL_CHARS_CHANGED;
+        }
+    }
+}
+
+void SnapshotBuffer::Publish(int64_t stamp) {
+    ProfileScope prof(PROF_SNAPSHOT);
+    // Once the renderer has taken the last snapshot, only this tick is new.
+    // If it takes it while this one is being written, the next snapshot just
+    // repeats a few changes.
+    if (!(middle.load(std::memory_order_acquire) & FRESH)) ResetPending();
+    AddTickChanges();
+
+    SimSnapshot& snap = slots[back];
+    snap.stamp = stamp;
+    snap.streams = g_streams;
+    snap.streams.respawned = pendingRespawned;
+    snap.streams.changedChar = pendingChangedChar;
+    snap.landed = g_landed;
+    snap.clears = g_monitorClears;
+    snap.topRow.resize(g_monitorFill.size());
+    for (size_t mi = 0; mi < g_monitorFill.size(); mi++) snap.topRow[mi] = g_monitorFill[mi].topRow;
+    snap.changedCells = pendingCells;
+    snap.changedBands = pendingBands;
+
+    int old = middle.exchange(back | FRESH, std::memory_order_acq_rel);
+    back = old & ~FRESH;
+    published.fetch_add(1, std::memory_order_relaxed);
+    // The renderer never saw the previous snapshot; its changes are still
+    // pending and went into this one
+    if (old & FRESH) dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool SnapshotBuffer::Acquire() {
+    if (!(middle.load(std::memory_order_relaxed) & FRESH)) {
+        reused.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    front = middle.exchange(front, std::memory_order_acq_rel) & ~FRESH;
+    return true;
+}
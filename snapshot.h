@@ -0,0 +1,76 @@
+// Matrix Tetris simulation snapshots
+// Everything a frame needs from the simulation, copied out after a tick, so a
+// render thread can draw one tick while the simulation thread computes the
+// next. Snapshots pass between the two through a lock-free triple buffer.
+// The layout (g_monitors, grid size) is fixed by InitSimulation and is read
+// directly rather than copied. Like the simulation, a snapshot keeps landed
+// cells and clears in each monitor's own coordinates; renderers place them.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "sim.h"
+
+struct SimSnapshot {
+    int64_t    stamp = 0;                       // publisher's clock when the tick ran
+    StreamSet  streams;
+    std::vector<LandedGrid> landed;             // one per monitor
+    std::vector<MonitorClearInfo> clears;       // one per monitor
+    std::vector<int> topRow;                    // per monitor: topmost content row (local)
+
+    // What changed since the snapshot the renderer took before this one.
+    // Ticks of snapshots that were dropped unseen are merged in, and so are
+    // streams.respawned and streams.changedChar.
+    std::vector<CellPos> changedCells;
+    std::vector<RowBand> changedBands;
+
+    // Place streams and drop animations for drawing at fraction alpha of the
+    // way from the previous tick to this one (1 = exactly this tick); fills
+    // streams.drawPx and clears[].drawDropOffset. Render side only.
+    void Interpolate(float alpha);
+};
+
+// Triple buffer: the simulation always has a slot to fill, the renderer
+// always has a slot to draw, and the third holds the newest finished snapshot
+// between them. Neither side ever waits for the other.
+class SnapshotBuffer {
+public:
+    // Simulation side: copy the state after a tick into the free slot and
+    // make it the newest snapshot. If the renderer never took the previous
+    // one, it is dropped and its changes carry over.
+    void Publish(int64_t stamp);
+
+    // Render side: take the newest snapshot if one arrived since the last
+    // call. Returns false (and the frame reuses Front()) otherwise.
+    bool Acquire();
+    SimSnapshot& Front() { return slots[front]; }
+
+    // Counters, readable from any thread
+    uint64_t Published() const { return published.load(std::memory_order_relaxed); }
+    uint64_t Dropped() const   { return dropped.load(std::memory_order_relaxed); }   // overwritten unseen: render is behind
+    uint64_t Reused() const    { return reused.load(std::memory_order_relaxed); }    // frames with nothing new: sim is behind
+
+private:
+    static const int FRESH = 4;  // middle holds a snapshot the renderer hasn't taken
+
+    SimSnapshot      slots[3];
+    int              back = 0;     // simulation's slot
+    int              front = 1;    // renderer's slot
+    std::atomic<int> middle{2};    // slot index | FRESH
+
+    // Simulation side: changes since the last snapshot known to be taken
+    std::vector<CellPos> pendingCells;
+    std::vector<RowBand> pendingBands;
+    std::vector<uint8_t> pendingRespawned;
+    std::vector<int>     pendingChangedChar;
+
+    std::atomic<uint64_t> published{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> reused{0};
+
+    void ResetPending();
+    void AddTickChanges();
+};
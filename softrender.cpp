@@ -0,0 +1,377 @@
+// Matrix Tetris software renderer — see softrender.h
+
+#include "softrender.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "profiler.h"
+
+#if defined(__AVX2__)
+#define SOFT_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SOFT_SSE2 1
+#endif
+#if defined(SOFT_AVX2)
+#include <immintrin.h>
+#elif defined(SOFT_SSE2)
+#include <emmintrin.h>
+#endif
+
+// ─── Framebuffer ─────────────────────────────────────────────────────────────
+
+void Framebuffer::Allocate(int w, int h) {
+    storage.assign((size_t)w * h, ColorToPixel(MakeColor(0, 0, 0)));
+    pixels = storage.data();
+    width  = w;
+    height = h;
+    stride = w;
+}
+
+void Framebuffer::Attach(Pixel* p, int w, int h, int rowStride) {
+    storage.clear();
+    pixels = p;
+    width  = w;
+    height = h;
+    stride = rowStride;
+}
+
+// ─── Kernels ─────────────────────────────────────────────────────────────────
+
+void FillSpan(Pixel* dst, int n, Pixel color) {
+    int i = 0;
+#if defined(SOFT_AVX2)
+    __m256i v8 = _mm256_set1_epi32((int)color);
+    for (; i + 8 <= n; i += 8) _mm256_storeu_si256((__m256i*)(dst + i), v8);
+#endif
+#if defined(SOFT_SSE2)
+    __m128i v4 = _mm_set1_epi32((int)color);
+    for (; i + 4 <= n; i += 4) _mm_storeu_si128((__m128i*)(dst + i), v4);
+#endif
+    for (; i < n; i++) dst[i] = color;
+}
+
+// dst + (color - dst) * a / 255 per channel, rounded; the SIMD paths compute
+// exactly the same integers so output does not depend on the instruction set
+static inline Pixel BlendPixel(Pixel d, Pixel c, int a) {
+    Pixel out = 0xFF000000u;
+    for (int sh = 0; sh < 24; sh += 8) {
+        int x = (int)((d >> sh) & 0xFF) * (255 - a) + (int)((c >> sh) & 0xFF) * a + 128;
+        x = (x + (x >> 8)) >> 8;
+        out |= (Pixel)x << sh;
+    }
+    return out;
+}
+
+#if defined(SOFT_SSE2)
+// Blend 8 colors held as 16-bit channels: (d * (255 - a) + c * a + 128) / 255
+static inline __m128i Blend16(__m128i d, __m128i c, __m128i a) {
+    const __m128i k255 = _mm_set1_epi16(255);
+    const __m128i k128 = _mm_set1_epi16(128);
+    __m128i x = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(d, _mm_sub_epi16(k255, a)),
+                                            _mm_mullo_epi16(c, a)), k128);
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+#endif
+#if defined(SOFT_AVX2)
+static inline __m256i Blend16(__m256i d, __m256i c, __m256i a) {
+    const __m256i k255 = _mm256_set1_epi16(255);
+    const __m256i k128 = _mm256_set1_epi16(128);
+    __m256i x = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(d, _mm256_sub_epi16(k255, a)),
+                                                  _mm256_mullo_epi16(c, a)), k128);
+    return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+#endif
+
+void BlendSpan(Pixel* dst, const uint8_t* cov, int n, Pixel color) {
+    int i = 0;
+#if defined(SOFT_AVX2)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i opaque = _mm256_set1_epi32((int)0xFF000000u);
+        const __m256i splat = _mm256_set1_epi32(0x01010101);
+        __m256i c8 = _mm256_set1_epi32((int)color);
+        __m256i cLo = _mm256_unpacklo_epi8(c8, zero);
+        __m256i cHi = _mm256_unpackhi_epi8(c8, zero);
+        for (; i + 8 <= n; i += 8) {
+            uint64_t a8;
+            memcpy(&a8, cov + i, 8);
+            if (a8 == 0) continue;  // fully transparent: color key
+            __m256i a = _mm256_mullo_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(cov + i))), splat);
+            __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+            __m256i lo = Blend16(_mm256_unpacklo_epi8(d, zero), cLo, _mm256_unpacklo_epi8(a, zero));
+            __m256i hi = Blend16(_mm256_unpackhi_epi8(d, zero), cHi, _mm256_unpackhi_epi8(a, zero));
+            _mm256_storeu_si256((__m256i*)(dst + i), _mm256_or_si256(_mm256_packus_epi16(lo, hi), opaque));
+        }
+    }
+#endif
+#if defined(SOFT_SSE2)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i opaque = _mm_set1_epi32((int)0xFF000000u);
+        __m128i c4 = _mm_set1_epi32((int)color);
+        __m128i cLo = _mm_unpacklo_epi8(c4, zero);
+        __m128i cHi = _mm_unpackhi_epi8(c4, zero);
+        for (; i + 4 <= n; i += 4) {
+            uint32_t a4;
+            memcpy(&a4, cov + i, 4);
+            if (a4 == 0) continue;  // fully transparent: color key
+            // a0 a1 a2 a3 -> each alpha repeated across its pixel's 4 channels
+            __m128i a = _mm_cvtsi32_si128((int)a4);
+            a = _mm_unpacklo_epi8(a, a);
+            a = _mm_unpacklo_epi16(a, a);
+            __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+            __m128i lo = Blend16(_mm_unpacklo_epi8(d, zero), cLo, _mm_unpacklo_epi8(a, zero));
+            __m128i hi = Blend16(_mm_unpackhi_epi8(d, zero), cHi, _mm_unpackhi_epi8(a, zero));
+            _mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_packus_epi16(lo, hi), opaque));
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        if (cov[i]) dst[i] = BlendPixel(dst[i], color, cov[i]);
+    }
+}
+
+void DarkenSpan(Pixel* dst, int n, int amount) {
+    const Pixel black = ColorToPixel(MakeColor(0, 0, 0));
+    if (amount >= 255) {
+        FillSpan(dst, n, black);
+        return;
+    }
+    int i = 0;
+#if defined(SOFT_AVX2)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i opaque = _mm256_set1_epi32((int)0xFF000000u);
+        const __m256i a = _mm256_set1_epi16((short)amount);
+        for (; i + 8 <= n; i += 8) {
+            __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+            __m256i lo = Blend16(_mm256_unpacklo_epi8(d, zero), zero, a);
+            __m256i hi = Blend16(_mm256_unpackhi_epi8(d, zero), zero, a);
+            _mm256_storeu_si256((__m256i*)(dst + i), _mm256_or_si256(_mm256_packus_epi16(lo, hi), opaque));
+        }
+    }
+#endif
+#if defined(SOFT_SSE2)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i opaque = _mm_set1_epi32((int)0xFF000000u);
+        const __m128i a = _mm_set1_epi16((short)amount);
+        for (; i + 4 <= n; i += 4) {
+            __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+            __m128i lo = Blend16(_mm_unpacklo_epi8(d, zero), zero, a);
+            __m128i hi = Blend16(_mm_unpackhi_epi8(d, zero), zero, a);
+            _mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_packus_epi16(lo, hi), opaque));
+        }
+    }
+#endif
+    for (; i < n; i++) dst[i] = BlendPixel(dst[i], black, amount);
+}
+
+// ─── Glyph atlas ─────────────────────────────────────────────────────────────
+
+void GlyphAtlas::BuildProcedural() {
+    // 5 × 7 grid of 2 × 2 pixel dots centred in the cell, pattern hashed from
+    // the character code so every glyph is distinct and runs are repeatable
+    coverage.assign((size_t)NUM_GLYPHS * CELL * CELL, 0);
+    const int dot = 2, gw = 5, gh = 7;
+    const int ox = (CELL - gw * dot) / 2, oy = (CELL - gh * dot) / 2;
+    for (int g = 0; g < GLYPH_BLANK; g++) {
+        uint32_t h = 2166136261u;  // FNV-1a
+        uint32_t ch = (uint32_t)GLYPH_CHARS[g];
+        for (int b = 0; b < 4; b++) {
+            h ^= (ch >> (b * 8)) & 0xFF;
+            h *= 16777619u;
+        }
+        uint8_t* glyph = Glyph(g);
+        for (int gy = 0; gy < gh; gy++) {
+            for (int gx = 0; gx < gw; gx++) {
+                h ^= h << 13; h ^= h >> 17; h ^= h << 5;
+                if ((h & 7) < 3) continue;
+                for (int y = 0; y < dot; y++)
+                    for (int x = 0; x < dot; x++)
+                        glyph[(oy + gy * dot + y) * CELL + ox + gx * dot + x] = 255;
+            }
+        }
+    }
+}
+
+// ─── Drawing helpers ─────────────────────────────────────────────────────────
+
+static void FillRectClipped(Framebuffer& fb, const PixelRect& clip, PixelRect rc, Pixel color) {
+    rc = IntersectPixelRect(rc, clip);
+    if (rc.Empty()) return;
+    for (int y = rc.top; y < rc.bottom; y++) {
+        FillSpan(fb.Row(y) + rc.left, rc.right - rc.left, color);
+    }
+}
+
+// Beveled block at (x, y): inner fill, bright top/left edge and optionally a
+// shadow bottom/right edge — the same pixels the GDI path draws. Without the
+// bevel only the fill is drawn.
+static void DrawBlock(Framebuffer& fb, const PixelRect& clip, int x, int y,
+                      Color fill, Color highlight, const Color* shadow, bool bevel) {
+    FillRectClipped(fb, clip, {x + 1, y + 1, x + CELL - 1, y + CELL - 1}, ColorToPixel(fill));
+    if (!bevel) return;
+    Pixel hi = ColorToPixel(highlight);
+    FillRectClipped(fb, clip, {x + 1, y + 1, x + CELL - 2, y + 2}, hi);
+    FillRectClipped(fb, clip, {x + 1, y + 1, x + 2, y + CELL - 2}, hi);
+    if (shadow) {
+        Pixel sh = ColorToPixel(*shadow);
+        FillRectClipped(fb, clip, {x + CELL - 2, y + 1, x + CELL - 1, y + CELL - 2}, sh);
+        FillRectClipped(fb, clip, {x + 1, y + CELL - 2, x + CELL - 2, y + CELL - 1}, sh);
+    }
+}
+
+static void DrawLandedBlock(Framebuffer& fb, const PixelRect& clip, LandedCell cell, int x, int y, bool bevel) {
+    const LandedShade& shade = LandedCellShade(cell);
+    DrawBlock(fb, clip, x, y, shade.fill, shade.edge, nullptr, bevel);
+}
+
+static void DrawGlyph(Framebuffer& fb, const PixelRect& clip, const uint8_t* glyph, int x, int y, Color color) {
+    PixelRect rc = IntersectPixelRect({x, y, x + CELL, y + CELL}, clip);
+    if (rc.Empty()) return;
+    Pixel px = ColorToPixel(color);
+    for (int yy = rc.top; yy < rc.bottom; yy++) {
+        BlendSpan(fb.Row(yy) + rc.left, glyph + (yy - y) * CELL + (rc.left - x), rc.right - rc.left, px);
+    }
+}
+
+// ─── Renderer ────────────────────────────────────────────────────────────────
+
+void SoftwareRenderer::RenderFrame(const SimSnapshot& snap, const std::vector<PixelRect>& rects) {
+    PixelRect screen = {0, 0, fb.width, fb.height};
+    const StreamSet& st = snap.streams;
+    int numStreams = st.size();
+    streamRects.resize(numStreams);
+    for (int i = 0; i < numStreams; i++) {
+        StreamRects& sr = streamRects[i];
+        sr.tailFull = StreamTailRect(st, i);
+        sr.tail  = IntersectPixelRect(sr.tailFull, MonitorPixelRect(g_monitors[st.monitorIdx[i]]));
+        sr.piece = StreamPieceRect(st, i);
+    }
+
+    // Bucket streams by column so each rect only looks at streams above it
+    colStart.assign(g_gridCols + 1, 0);
+    for (int i = 0; i < numStreams; i++) colStart[st.drawCol[i] + 1]++;
+    for (int c = 0; c < g_gridCols; c++) colStart[c + 1] += colStart[c];
+    colStreams.resize(numStreams);
+    colFill.assign(colStart.begin(), colStart.end() - 1);
+    for (int i = 0; i < numStreams; i++) colStreams[colFill[st.drawCol[i]]++] = i;
+
+    if ((int)scanlineMask.size() != fb.height || scanlineMaskFor != scanlines) {
+        scanlines.BuildMask(scanlineMask, fb.height);
+        scanlineMaskFor = scanlines;
+    }
+
+    for (const auto& d : rects) {
+        PixelRect clip = IntersectPixelRect(d, screen);
+        if (!clip.Empty()) RenderRect(snap, clip);
+    }
+}
+
+void SoftwareRenderer::RenderRect(const SimSnapshot& snap, const PixelRect& clip) {
+    ProfileScope prof(PROF_CLEAR);
+    FillRectClipped(fb, clip, clip, ColorToPixel(MakeColor(0, 0, 0)));
+
+    // ── Landed blocks ────────────────────────────────────────────────────
+    prof.Switch(PROF_LANDED);
+    for (size_t mi = 0; mi < g_monitors.size(); mi++) {
+        const auto& m = g_monitors[mi];
+        PixelRect monClip = IntersectPixelRect(clip, MonitorPixelRect(m));
+        if (monClip.Empty()) continue;
+        const LandedGrid& landed = snap.landed[mi];
+        const MonitorClearInfo& mci = snap.clears[mi];
+        // The clip in the monitor's cells
+        int r0 = monClip.top / CELL - m.top,  r1 = (monClip.bottom - 1) / CELL - m.top;
+        int c0 = monClip.left / CELL - m.left, c1 = (monClip.right - 1) / CELL - m.left;
+        int x0 = m.left * CELL, y0 = m.top * CELL;
+
+        // During a drop animation the rows above the cleared zone slide down
+        // by the drop offset; the rest stay put
+        bool dropping = mci.phase == CLEAR_DROP;
+        for (int r = std::max(r0, dropping ? mci.highestRow : 0); r <= r1; r++) {
+            const LandedCell* row = landed.Row(r);
+            for (int c = c0; c <= c1; c++) {
+                if (row[c].Filled()) DrawLandedBlock(fb, clip, row[c], x0 + c * CELL, y0 + r * CELL, bevels);
+            }
+        }
+        if (!dropping) continue;
+        int shift = mci.drawDropOffset;
+        int rFirst = std::max(0, (monClip.top - y0 - shift) / CELL - 1);
+        int rLast  = std::min(mci.highestRow - 1, (monClip.bottom - 1 - y0 - shift) / CELL);
+        for (int r = rFirst; r <= rLast; r++) {
+            const LandedCell* row = landed.Row(r);
+            for (int c = c0; c <= c1; c++) {
+                if (row[c].Filled()) DrawLandedBlock(fb, monClip, row[c], x0 + c * CELL, y0 + r * CELL + shift, bevels);
+            }
+        }
+    }
+
+    // ── Flash animation for cleared rows ─────────────────────────────────
+    prof.Switch(PROF_FLASH);
+    for (const auto& mci : snap.clears) {
+        if (mci.phase != CLEAR_FLASH) continue;
+        int alpha = std::min(mci.flashTick * 12, 255);
+        Pixel flash = ColorToPixel(MakeColor(0, alpha, alpha / 3));
+        const auto& m = g_monitors[mci.monIdx];
+        for (int row : mci.rows) {
+            int y = (m.top + row) * CELL;
+            FillRectClipped(fb, clip, {m.left * CELL, y, m.right * CELL, y + CELL}, flash);
+        }
+    }
+
+    // ── Matrix streams and Tetris pieces ─────────────────────────────────
+    const Color highlight = MakeColor(200, 255, 220);
+    // A piece's 4×4 box spans columns col - 1 .. col + 2. Overlapping streams
+    // must be drawn in stream order, as the GDI path does.
+    int c0 = clip.left / CELL, c1 = std::min((clip.right - 1) / CELL, g_gridCols - 1);
+    int sc0 = std::max(c0 - 2, 0), sc1 = std::min(c1 + 1, g_gridCols - 1);
+    candidates.assign(colStreams.begin() + colStart[sc0], colStreams.begin() + colStart[sc1 + 1]);
+    std::sort(candidates.begin(), candidates.end());
+    const StreamSet& st = snap.streams;
+    for (int si : candidates) {
+        const StreamRects& sr = streamRects[si];
+        PixelRect tail = IntersectPixelRect(sr.tail, clip);
+        PixelRect piece = IntersectPixelRect(sr.piece, clip);
+        if (tail.Empty() && piece.Empty()) continue;
+        const PixelRect& tailFull = sr.tailFull;
+
+        // Tail: index 0 (head) is the bottom cell of the strip
+        if (!tail.Empty()) {
+            prof.Switch(PROF_TAILS);
+            PixelRect tailClip = IntersectPixelRect(MonitorPixelRect(g_monitors[st.monitorIdx[si]]), clip);
+            const wchar_t* chars = st.Chars(si);
+            const Color* colors = st.TailColors(si);
+            int iFirst = (tailFull.bottom - tail.bottom) / CELL;
+            int iLast  = std::min((tailFull.bottom - tail.top - 1) / CELL, st.length[si] - 1);
+            for (int i = iFirst; i <= iLast; i++) {
+                int g = GlyphIndex(chars[i]);
+                if (g == GLYPH_BLANK) continue;
+                DrawGlyph(fb, tailClip, atlas.Glyph(g), tailFull.left, tailFull.bottom - (i + 1) * CELL,
+                          colors[i]);
+            }
+        }
+
+        if (piece.Empty()) continue;
+        prof.Switch(PROF_PIECES);
+        const PieceShape& shape = PIECE_SHAPES[st.pieceType[si]][st.rotation[si]];
+        const auto& mon = g_monitors[st.monitorIdx[si]];
+        Color pieceColor = st.PieceColor(si);
+        Color shadow = DimColor(pieceColor, 100);
+        int headPx = st.drawPx[si];
+        for (int i = 0; i < 4; i++) {
+            int py = headPx + shape.cellRow[i] * CELL;
+            int gc = st.drawCol[si] + shape.cellCol[i] - 1;
+            if (py < mon.top * CELL || py + CELL > mon.bottom * CELL || gc < mon.left || gc >= mon.right) continue;
+            DrawBlock(fb, clip, gc * CELL, py, pieceColor, highlight, &shadow, bevels);
+        }
+    }
+
+    // ── Scanline overlay for CRT effect ──────────────────────────────────
+    prof.Switch(PROF_SCANLINES);
+    for (int y = clip.top; y < clip.bottom; y++) {
+        if (scanlineMask[y]) DarkenSpan(fb.Row(y) + clip.left, clip.right - clip.left, scanlineMask[y]);
+    }
+}
@@ -0,0 +1,89 @@
+// Matrix Tetris software renderer
+// Draws the scene into a plain 32-bit BGRA framebuffer with SSE2/AVX2 fill and
+// blend kernels, no GDI involved. On Windows the framebuffer is a DIB section
+// presented with one BitBlt per frame; headless it can be written out as PNG.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "renderer.h"
+#include "sim.h"
+
+// ─── Framebuffer ─────────────────────────────────────────────────────────────
+
+// 0xAARRGGBB in memory order B, G, R, A — the layout of a 32bpp DIB
+typedef uint32_t Pixel;
+
+constexpr Pixel ColorToPixel(Color c) {
+    return 0xFF000000u | ((Pixel)ColorR(c) << 16) | ((Pixel)ColorG(c) << 8) | (Pixel)ColorB(c);
+}
+
+struct Framebuffer {
+    Pixel* pixels = nullptr;     // top-down rows
+    int    width  = 0;
+    int    height = 0;
+    int    stride = 0;           // pixels per row
+    std::vector<Pixel> storage;  // backing store when the framebuffer owns its pixels
+
+    // Own a black width × height buffer
+    void Allocate(int w, int h);
+    // Draw into memory owned by someone else (e.g. a DIB section)
+    void Attach(Pixel* p, int w, int h, int rowStride);
+
+    Pixel* Row(int y) { return pixels + (size_t)y * stride; }
+    const Pixel* Row(int y) const { return pixels + (size_t)y * stride; }
+};
+
+// ─── Glyph atlas ─────────────────────────────────────────────────────────────
+
+// One CELL × CELL 8-bit coverage mask per glyph (glyphs.h); GLYPH_BLANK is empty
+struct GlyphAtlas {
+    std::vector<uint8_t> coverage;  // [glyph][y][x]
+
+    uint8_t* Glyph(int i) { return &coverage[(size_t)i * CELL * CELL]; }
+    const uint8_t* Glyph(int i) const { return &coverage[(size_t)i * CELL * CELL]; }
+
+    // Deterministic blocky stand-in glyphs derived from the character code,
+    // for headless runs where no font rasterizer is available
+    void BuildProcedural();
+};
+
+// ─── Renderer ────────────────────────────────────────────────────────────────
+
+class SoftwareRenderer : public Renderer {
+public:
+    Framebuffer fb;
+    GlyphAtlas  atlas;
+
+    void RenderFrame(const SimSnapshot& snap, const std::vector<PixelRect>& rects) override;
+
+private:
+    // Per-frame stream footprints, computed once and culled against each rect
+    struct StreamRects {
+        PixelRect tailFull;  // whole tail strip, unclipped
+        PixelRect tail;      // tail clipped to the stream's monitor
+        PixelRect piece;     // piece bounding box, clipped to the monitor
+    };
+    std::vector<StreamRects> streamRects;
+    // Streams bucketed by grid column: colStreams[colStart[c] .. colStart[c + 1])
+    std::vector<int> colStart;
+    std::vector<int> colStreams;
+    std::vector<int> colFill;
+    std::vector<int> candidates;  // streams near the current rect, in draw order
+    std::vector<uint8_t> scanlineMask;    // [y] darkening, built from scanlines
+    ScanlineSettings     scanlineMaskFor; // settings the mask was built for
+
+    void RenderRect(const SimSnapshot& snap, const PixelRect& clip);
+};
+
+// ─── Kernels ─────────────────────────────────────────────────────────────────
+// Exposed for the headless benchmark; all take already-clipped spans.
+
+// Write color to n consecutive pixels
+void FillSpan(Pixel* dst, int n, Pixel color);
+// Blend color over n pixels using 8-bit coverage as alpha (0 leaves dst as is)
+void BlendSpan(Pixel* dst, const uint8_t* cov, int n, Pixel color);
+// Blend black over n pixels with a constant alpha (255 = black)
+void DarkenSpan(Pixel* dst, int n, int amount);
@@ -0,0 +1,69 @@
+// Matrix Tetris worker pool — see workers.h
+
+#include "workers.h"
+
+void WorkerPool::Start(int numThreads) {
+    Stop();
+    for (int i = 1; i < numThreads; i++) workers.emplace_back(&WorkerPool::WorkerLoop, this);
+}
+
+void WorkerPool::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& t : workers) t.join();
+    workers.clear();
+    stopping = false;
+}
+
+void WorkerPool::ParallelFor(int count, void (*fn)(int)) {
+    if (count <= 0) return;
+    if (workers.empty() || count == 1) {
+        for (int i = 0; i < count; i++) fn(i);
+        return;
+    }
+    {
+        // A worker that woke too late for the previous batch may still be
+        // looking at it; let it leave before the batch is replaced
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this] { return busy == 0; });
+        task = fn;
+        taskCount = count;
+        next.store(0, std::memory_order_relaxed);
+        batch++;
+    }
+    wake.notify_all();
+    RunTasks();
+
+    // Join: every task is claimed; wait for the ones still running on workers
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return busy == 0; });
+}
+
+void WorkerPool::RunTasks() {
+    for (;;) {
+        int i = next.fetch_add(1, std::memory_order_relaxed);
+        if (i >= taskCount) return;
+        task(i);
+    }
+}
+
+void WorkerPool::WorkerLoop() {
+    unsigned seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || batch != seen; });
+            if (stopping) return;
+            seen = batch;
+            busy++;
+        }
+        RunTasks();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--busy == 0) idle.notify_all();
+        }
+    }
+}
@@ -0,0 +1,43 @@
+// Matrix Tetris worker pool
+// A fixed set of threads that run the tasks of one parallel-for at a time.
+// The calling thread works alongside them and returns only once every task
+// has finished, so a ParallelFor is a complete fork/join.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkerPool {
+public:
+    ~WorkerPool() { Stop(); }
+
+    // Use numThreads threads in total, counting the caller (<= 1: no workers)
+    void Start(int numThreads);
+    void Stop();
+    int  Threads() const { return (int)workers.size() + 1; }
+
+    // Run fn(i) for every i in [0, count) and wait for all of them
+    void ParallelFor(int count, void (*fn)(int));
+
+private:
+    std::vector<std::thread> workers;
+    std::mutex               mutex;
+    std::condition_variable  wake;      // workers: a new batch was posted (or stop)
+    std::condition_variable  idle;      // caller: the last busy worker left its batch
+    unsigned                 batch = 0; // bumped for every ParallelFor
+    int                      busy = 0;  // workers inside RunTasks
+    bool                     stopping = false;
+
+    // Current batch, only rewritten while no worker is busy; tasks are
+    // claimed by bumping next
+    void (*task)(int) = nullptr;
+    int              taskCount = 0;
+    std::atomic<int> next{0};
+
+    void WorkerLoop();
+    void RunTasks();
+};